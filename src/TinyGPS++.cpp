@@ -22,43 +22,72 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
 #include "TinyGPS++.h"
+#include "TinyGPSTrig.h"
 
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <float.h>
 
-#define _GPRMCterm   "GPRMC"
-#define _GPGGAterm   "GPGGA"
-#define _GPGSVterm   "GPGSV"
-#define _GPVTGterm   "GPVTG"
-#define _GPGSAterm   "GPGSA"
-#define _GPGLLterm   "GPGLL"
-#define _GNRMCterm   "GNRMC"
-#define _GNGGAterm   "GNGGA"
+static TinyGPSStream &defaultStream()
+{
+  static TinyGPSSerialStream<decltype(Serial)> serialStream(Serial);
+  return serialStream;
+}
 
 TinyGPSPlus::TinyGPSPlus()
-  :  parity(0)
+  :  TinyGPSPlus(defaultStream())
+{
+}
+
+TinyGPSPlus::TinyGPSPlus(TinyGPSStream &_stream)
+  :  sentence_GsvOff{"$PUBX,40,GSV,0,0,0,0,0,0*59"}
+  ,  sentence_GsvOn{"$PUBX,40,GSV,0,1,0,0,0,0*58"}
+  ,  sentence_GsaOff{"$PUBX,40,GSA,0,0,0,0,0,0*4E"}
+  ,  sentence_GsaOn{"$PUBX,40,GSA,0,1,0,0,0,0*4F"}
+  ,  sentence_VtgOff{"$PUBX,40,VTG,0,0,0,0,0,0*5E"}
+  ,  sentence_VtgOn{"$PUBX,40,VTG,0,1,0,0,0,0*5F"}
+  ,  sentence_GllOff{"$PUBX,40,GLL,0,0,0,0,0,0*5C"}
+  ,  sentence_GllOn{"$PUBX,40,GLL,0,1,0,0,0,0*5D"}
+  ,  sentence_5000msPeriod{0xb5, 0x62, 0x6, 0x8, 0x6, 0x0, 0x88, 0x13, 0x1, 0x0, 0x1, 0x0, 0xb1, 0x49}
+  ,  sentence_100msPeriod{0xb5, 0x62, 0x6, 0x8, 0x6, 0x0, 0x64, 0x0, 0x1, 0x0, 0x1, 0x0, 0x7a, 0x12}
+  ,  stream(_stream)
+  ,  rxHead(0)
+  ,  rxTail(0)
+  ,  rxTime(0)
+  ,  parity(0)
   ,  isChecksumTerm(false)
   ,  curSentenceType(GPS_SENTENCE_OTHER)
   ,  curTermNumber(0)
   ,  curTermOffset(0)
   ,  sentenceHasFix(false)
+  ,  inSentence(false)
+  ,  isTextTerm(false)
+  ,  endedByCr(false)
+  ,  sentenceLength(0)
+  ,  sentenceStartTime(0)
+  ,  hasReadTime(false)
+  ,  readTime(0)
+  ,  lazyDecoding(false)
+  ,  decodeFields((1u << TinyGPSSnapshot::FIELD_COUNT) - 1)
+#if _GPS_LAZY_BUFFER_SIZE
+  ,  lazyLength(0)
+  ,  lazyTermCount(0)
+#endif
   ,  customElts(0)
   ,  customCandidates(0)
+  ,  listeners(0)
+  ,  fieldCommits{}
+  ,  lastCommitTime(0)
+  ,  changes{}
+  ,  changeTokens(0)
+  ,  sentenceView(0)
   ,  encodedCharCount(0)
   ,  sentencesWithFixCount(0)
   ,  failedChecksumCount(0)
   ,  passedChecksumCount(0)
-  ,  sentence_GsvOff{"$PUBX,40,GSV,0,0,0,0,0,0*59"}
-  ,  sentence_GsvOn{"$PUBX,40,GSV,0,1,0,0,0,0*58"}
-  ,  sentence_GsaOff{"$PUBX,40,GSA,0,0,0,0,0,0*4E"}
-  ,  sentence_GsaOn{"$PUBX,40,GSA,0,1,0,0,0,0*4F"}
-  ,  sentence_VtgOff{"$PUBX,40,VTG,0,0,0,0,0,0*5E"}
-  ,  sentence_VtgOn{"$PUBX,40,VTG,0,1,0,0,0,0*5F"}
-  ,  sentence_GllOff{"$PUBX,40,GLL,0,0,0,0,0,0*5C"}
-  ,  sentence_GllOn{"$PUBX,40,GLL,0,1,0,0,0,0*5D"}
-  ,  sentence_5000msPeriod{0xb5, 0x62, 0x6, 0x8, 0x6, 0x0, 0x88, 0x13, 0x1, 0x0, 0x1, 0x0, 0xb1, 0x49}
-  ,  sentence_100msPeriod{0xb5, 0x62, 0x6, 0x8, 0x6, 0x0, 0x64, 0x0, 0x1, 0x0, 0x1, 0x0, 0x7a, 0x12}
+  ,  lazyOverflowCount(0)
+  ,  ubxState(0)
 {
   term[0] = '\0';
 }
@@ -70,18 +99,30 @@ TinyGPSPlus::TinyGPSPlus()
 bool TinyGPSPlus::readSerial()
 {
     bool retVal{false};
-    while (Serial.available())
+    while (readSerialGiveStatus() != EncodeStatus::UNFINISHED)
     {
-        retVal |= encode(Serial.read());
+        retVal = true;
     }
     return retVal;
 }
 TinyGPSPlus::EncodeStatus TinyGPSPlus::readSerialGiveStatus()
 {
     EncodeStatus retVal{EncodeStatus::UNFINISHED};
-    while (Serial.available() and retVal == EncodeStatus::UNFINISHED)
+    while (retVal == EncodeStatus::UNFINISHED)
     {
-        retVal = encodeGiveStatus(Serial.read());
+        if (rxHead == rxTail)
+        {
+            rxHead = 0;
+            rxTail = stream.read(rxBuffer, sizeof(rxBuffer));
+            if (rxTail == 0)
+            {
+                break;
+            }
+            rxTime = millis();
+        }
+        size_t consumed{0};
+        retVal = encodeGiveStatus((const char*)rxBuffer + rxHead, rxTail - rxHead, consumed, rxTime);
+        rxHead += consumed;
     }
     return retVal;
 }
@@ -96,6 +137,14 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeGiveStatus(char c)
 {
   ++encodedCharCount;
 
+  // Between sentences, or after a framing error, only '$' and UBX frames matter
+  if (!inSentence && (ubxState > 1 || c != '$'))
+  {
+    ubxByte((uint8_t)c);
+    return EncodeStatus::UNFINISHED;
+  }
+  ++sentenceLength;
+
   switch(c)
   {
   case ',': // term terminators
@@ -104,29 +153,74 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeGiveStatus(char c)
   case '\n':
   case '*':
     {
-      EncodeStatus status = EncodeStatus::UNFINISHED;
-      if (curTermOffset < sizeof(term))
+      if (c == '\r' || c == '\n')
       {
-        term[curTermOffset] = 0;
-        status = endOfTermHandler();
+        if (!isChecksumTerm)
+        {
+          corruption.missingChecksum++;
+          return framingError();
+        }
+        inSentence = false;
+        endedByCr = c == '\r';
       }
+      term[curTermOffset] = 0;
+      EncodeStatus status = endOfTermHandler();
       ++curTermNumber;
       curTermOffset = 0;
       isChecksumTerm = c == '*';
+      isTextTerm = !isChecksumTerm && termDecoder() == TERM_TEXT;
+      if (isTextTerm)
+        txt.begin();
       return status;
     }
     break;
 
   case '$': // sentence begin
-    curTermNumber = curTermOffset = 0;
-    parity = 0;
-    curSentenceType = GPS_SENTENCE_OTHER;
-    isChecksumTerm = false;
-    sentenceHasFix = false;
-    return EncodeStatus::UNFINISHED;
+    {
+      EncodeStatus status = EncodeStatus::UNFINISHED;
+      if (inSentence)
+      {
+        corruption.truncated++;
+        status = EncodeStatus::INVALID;
+      }
+      inSentence = true;
+      ubxState = 0;
+      sentenceLength = 1;
+      curTermNumber = curTermOffset = 0;
+      parity = 0;
+      curSentenceType = GPS_SENTENCE_OTHER;
+      isChecksumTerm = false;
+      isTextTerm = false;
+      sentenceHasFix = false;
+      sentenceStartTime = hasReadTime ? readTime : millis();
+#if _GPS_LAZY_BUFFER_SIZE
+      lazyLength = lazyTermCount = 0;
+#endif
+      if (sentenceView)
+        sentenceView->clear();
+      return status;
+    }
 
   default: // ordinary characters
-    if (curTermOffset < sizeof(term) - 1)
+    if ((uint8_t)c < 0x20 || (uint8_t)c > 0x7E)
+    {
+      corruption.nonPrintable++;
+      ubxByte((uint8_t)c); // may be the sync byte of a UBX frame
+      return framingError();
+    }
+    if (isTextTerm)
+    {
+      // Free text may exceed the term buffer; it goes straight to txt
+      txt.append(c);
+      if (curTermOffset < sizeof(term) - 1)
+        term[curTermOffset++] = c;
+    }
+    else if (curTermOffset >= sizeof(term) - 1)
+    {
+      corruption.overlongTerm++;
+      return framingError();
+    }
+    else
       term[curTermOffset++] = c;
     if (!isChecksumTerm)
       parity ^= c;
@@ -136,6 +230,129 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeGiveStatus(char c)
   return EncodeStatus::UNFINISHED;
 }
 
+TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeGiveStatus(const char *buf, size_t len, size_t &consumed)
+{
+  EncodeStatus status = EncodeStatus::UNFINISHED;
+  size_t i = 0;
+  while (i < len && status == EncodeStatus::UNFINISHED)
+  {
+    if (!inSentence && ubxState == 0)
+    {
+      // memchr is vectorized by the C library; skip junk in one pass,
+      // stopping at a '$' or a UBX sync byte
+      const char *dollar = (const char *)memchr(buf + i, '$', len - i);
+      size_t next = dollar ? (size_t)(dollar - buf) : len;
+      const char *sync = (const char *)memchr(buf + i, 0xB5, next - i);
+      if (sync)
+        next = (size_t)(sync - buf);
+      encodedCharCount += next - i;
+      i = next;
+      if (i == len)
+        break;
+    }
+    status = encodeGiveStatus(buf[i++]);
+  }
+  consumed = i;
+  return status;
+}
+
+TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeGiveStatus(const char *buf, size_t len, size_t &consumed, uint32_t _readTime)
+{
+  hasReadTime = true;
+  readTime = _readTime;
+  const EncodeStatus status = encodeGiveStatus(buf, len, consumed);
+  hasReadTime = false;
+  return status;
+}
+
+// The sentence starting at buf[0] ('$') or in progress, up to its end
+// or until it is dropped; what follows is left to the caller
+TinyGPSPlus::EncodeStatus TinyGPSPlus::encodeSentence(const char *buf, size_t len, size_t &consumed)
+{
+  if (!inSentence)
+    ubxState = 0;
+  EncodeStatus status = EncodeStatus::UNFINISHED;
+  size_t i = 0;
+  do
+    status = encodeGiveStatus(buf[i++]);
+  while (i < len && inSentence && status == EncodeStatus::UNFINISHED);
+  consumed = i;
+  return status;
+}
+
+// Drops the current sentence and skips input until the next '$'
+TinyGPSPlus::EncodeStatus TinyGPSPlus::framingError()
+{
+  inSentence = false;
+  isTextTerm = false;
+  curSentenceType = GPS_SENTENCE_OTHER;
+  customCandidates = 0;
+  return EncodeStatus::INVALID;
+}
+
+// UBX frame: B5 62 class id length(2, LE) payload ck_a ck_b. Anything
+// but an ACK-ACK/NAK is dropped at its header, so a false sync byte
+// costs at most a few bytes.
+void TinyGPSPlus::ubxByte(uint8_t b)
+{
+  switch (ubxState)
+  {
+  case 0:
+    if (b == 0xB5)
+      ubxState = 1;
+    return;
+  case 1:
+    ubxState = b == 0x62 ? 2 : 0;
+    ubxCkA = ubxCkB = 0;
+    return;
+  case 7: // ck_a
+    ubxState = b == ubxCkA ? 8 : 0;
+    return;
+  case 8: // ck_b
+    ubxState = 0;
+    if (b == ubxCkB)
+      ubxFrame(ubxClass, ubxId, ubxPayload, ubxLength);
+    return;
+  }
+
+  ubxCkA += b;
+  ubxCkB += ubxCkA;
+  switch (ubxState)
+  {
+  case 2:
+    ubxClass = b;
+    ubxState = b == 0x05 ? 3 : 0;
+    break;
+  case 3:
+    ubxId = b;
+    ubxState = b <= 0x01 ? 4 : 0;
+    break;
+  case 4:
+    ubxLength = b;
+    ubxState = 5;
+    break;
+  case 5:
+    ubxLength |= (uint16_t)b << 8;
+    ubxOffset = 0;
+    ubxState = ubxLength == sizeof(ubxPayload) ? 6 : 0;
+    break;
+  case 6:
+    if (ubxOffset < sizeof(ubxPayload))
+      ubxPayload[ubxOffset] = b;
+    if (++ubxOffset == ubxLength)
+      ubxState = 7;
+    break;
+  }
+}
+
+// A UBX frame whose checksum passed
+void TinyGPSPlus::ubxFrame(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length)
+{
+  if (msgClass == 0x05 && msgId <= 0x01 && length == 2)
+    for (TinyGPSListener *l = listeners; l != NULL; l = l->next)
+      l->onUbxAck(payload[0], payload[1], msgId == 0x01);
+}
+
 //
 // internal utilities
 //
@@ -166,6 +383,38 @@ int32_t TinyGPSPlus::parseDecimal(const char *term)
   return negative ? -ret : ret;
 }
 
+// static
+// Parse a (potentially negative) decimal into value * 10^decimals in one
+// pass, rounding half away from zero on the first dropped digit
+int32_t TinyGPSPlus::parseFixed(const char *term, uint8_t decimals)
+{
+  bool negative = *term == '-';
+  if (negative) ++term;
+  int32_t ret = 0;
+  while (isdigit(*term))
+    ret = 10 * ret + (*term++ - '0');
+  if (*term == '.')
+    ++term;
+  for (uint8_t i = 0; i < decimals; ++i)
+  {
+    ret *= 10;
+    if (isdigit(*term))
+      ret += *term++ - '0';
+  }
+  if (*term >= '5' && *term <= '9')
+    ++ret;
+  return negative ? -ret : ret;
+}
+
+// static
+int32_t TinyGPSPlus::rescale(int32_t value, uint8_t from, uint8_t to)
+{
+  if (to >= from)
+    return value * TinyGPSDecimal::pow10(to - from);
+  const int32_t divisor = TinyGPSDecimal::pow10(from - to);
+  return (value + (value < 0 ? -divisor : divisor) / 2) / divisor;
+}
+
 // static
 // Parse degrees in that funny NMEA format DDMM.MMMM
 void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
@@ -191,7 +440,81 @@ void TinyGPSPlus::parseDegrees(const char *term, RawDegrees &deg)
   deg.negative = false;
 }
 
-#define COMBINE(sentence_type, term_number) (((unsigned)(sentence_type) << 5) | term_number)
+#define FIELD(field) (1u << TinyGPSSnapshot::field)
+
+// Sentence descriptors. A new sentence costs a name row, a term row, a
+// descriptor row and its commit function; terms are dispatched by
+// indexing termTable instead of a (sentence, term) switch.
+const TinyGPSPlus::SentenceName TinyGPSPlus::sentenceNames[] =
+{
+  {"GPRMC", GPS_SENTENCE_GPRMC}, {"GNRMC", GPS_SENTENCE_GPRMC},
+  {"GPGGA", GPS_SENTENCE_GPGGA}, {"GNGGA", GPS_SENTENCE_GPGGA},
+  {"GPGSV", GPS_SENTENCE_GPGSV},
+  {"GPVTG", GPS_SENTENCE_GPVTG},
+  {"GPGSA", GPS_SENTENCE_GPGSA},
+  {"GPGLL", GPS_SENTENCE_GPGLL},
+  {"GPZDA", GPS_SENTENCE_ZDA}, {"GNZDA", GPS_SENTENCE_ZDA},
+  {"GPGST", GPS_SENTENCE_GST}, {"GNGST", GPS_SENTENCE_GST},
+  {"GPGNS", GPS_SENTENCE_GNS}, {"GNGNS", GPS_SENTENCE_GNS},
+  {"GPTXT", GPS_SENTENCE_TXT}, {"GNTXT", GPS_SENTENCE_TXT},
+  {"", GPS_SENTENCE_OTHER}
+};
+
+const uint8_t TinyGPSPlus::termTable[GPS_SENTENCE_OTHER][_GPS_MAX_TERMS] =
+{
+  // GGA
+  {TERM_NONE, TERM_TIME, TERM_LAT, TERM_NS, TERM_LNG, TERM_EW, TERM_GGA_QUALITY, TERM_SATELLITES, TERM_HDOP, TERM_ALTITUDE},
+  // RMC
+  {TERM_NONE, TERM_TIME, TERM_RMC_STATUS, TERM_LAT, TERM_NS, TERM_LNG, TERM_EW, TERM_SPEED, TERM_COURSE, TERM_DATE},
+  // GSV: header, then four (id, elevation, azimuth, snr) blocks
+  {TERM_NONE, TERM_GSV_TOTAL, TERM_GSV_NUMBER, TERM_GSV_COUNT,
+   TERM_GSV_ID, TERM_NONE, TERM_NONE, TERM_GSV_SNR, TERM_GSV_ID, TERM_NONE, TERM_NONE, TERM_GSV_SNR,
+   TERM_GSV_ID, TERM_NONE, TERM_NONE, TERM_GSV_SNR, TERM_GSV_ID, TERM_NONE, TERM_NONE, TERM_GSV_SNR},
+  // VTG
+  {TERM_NONE, TERM_NONE, TERM_NONE, TERM_NONE, TERM_NONE, TERM_NONE, TERM_NONE, TERM_GROUND_SPEED},
+  // GSA
+  {TERM_NONE, TERM_GSA_MODE, TERM_GSA_FIX,
+   TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT,
+   TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT, TERM_GSA_SAT,
+   TERM_PDOP, TERM_GSA_HDOP, TERM_VDOP},
+  // GLL: counted only
+  {TERM_NONE},
+  // ZDA
+  {TERM_NONE, TERM_TIME, TERM_DAY, TERM_MONTH, TERM_YEAR},
+  // GST
+  {TERM_NONE, TERM_NONE, TERM_GST_RMS, TERM_GST_MAJOR, TERM_GST_MINOR, TERM_GST_ORIENTATION,
+   TERM_GST_LAT, TERM_GST_LNG, TERM_GST_ALT},
+  // GNS
+  {TERM_NONE, TERM_TIME, TERM_LAT, TERM_NS, TERM_LNG, TERM_EW, TERM_GNS_MODE, TERM_SATELLITES, TERM_HDOP, TERM_ALTITUDE},
+  // TXT
+  {TERM_NONE, TERM_NONE, TERM_NONE, TERM_TXT_TYPE, TERM_TEXT}
+};
+
+const TinyGPSPlus::SentenceDescriptor TinyGPSPlus::sentenceTable[GPS_SENTENCE_OTHER] =
+{
+  {EncodeStatus::GGA, &Stats::gga, &TinyGPSPlus::commitGga},
+  {EncodeStatus::RMC, &Stats::rmc, &TinyGPSPlus::commitRmc},
+  {EncodeStatus::GSV, &Stats::gsv, &TinyGPSPlus::commitGsv},
+  {EncodeStatus::VTG, &Stats::vtg, &TinyGPSPlus::commitVtg},
+  {EncodeStatus::GSA, &Stats::gsa, &TinyGPSPlus::commitGsa},
+  {EncodeStatus::GLL, &Stats::gll, &TinyGPSPlus::commitGll},
+  {EncodeStatus::ZDA, &Stats::zda, &TinyGPSPlus::commitZda},
+  {EncodeStatus::GST, &Stats::gst, &TinyGPSPlus::commitGst},
+  {EncodeStatus::GNS, &Stats::gns, &TinyGPSPlus::commitGns},
+  {EncodeStatus::TXT, &Stats::txt, &TinyGPSPlus::commitTxt}
+};
+
+// Unsized; wantTerm() checks that there is an entry per decoder
+const uint16_t TinyGPSPlus::termFields[] =
+{
+  0, FIELD(TIME), 0, FIELD(LOCATION), FIELD(LOCATION), FIELD(LOCATION), FIELD(LOCATION),
+  FIELD(SPEED), FIELD(COURSE), FIELD(DATE), 0, FIELD(SATELLITES), FIELD(HDOP), FIELD(ALTITUDE),
+  FIELD(SATS_IN_VIEW), FIELD(SATS_IN_VIEW), FIELD(SATS_IN_VIEW), FIELD(SATS_IN_VIEW), FIELD(SATS_IN_VIEW),
+  FIELD(GROUND_SPEED), FIELD(GSA), FIELD(GSA), FIELD(GSA), FIELD(GSA), FIELD(GSA), FIELD(GSA),
+  FIELD(DATE), FIELD(DATE), FIELD(DATE),
+  0, 0, 0, 0, 0, 0, 0, // GST
+  0, 0, 0              // GNS mode, TXT
+};
 
 // Processes a just-completed term
 // Returns true if new sentence has just passed checksum test and is validated
@@ -206,59 +529,44 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::endOfTermHandler()
     if (checksum == parity)
     {
       passedChecksumCount++;
+#if _GPS_LAZY_BUFFER_SIZE
+      if (lazyTermCount)
+        decodeStoredTerms();
+#endif
       if (sentenceHasFix)
         ++sentencesWithFixCount;
 
-      switch(curSentenceType)
+      if (curSentenceType != GPS_SENTENCE_OTHER)
       {
-      case GPS_SENTENCE_GPRMC:
-        date.commit();
-        time.commit();
-        if (sentenceHasFix)
-        {
-           location.commit();
-           speed.commit();
-           course.commit();
-        }
-        stats.rmc++;
-        retValue = EncodeStatus::RMC;
-        break;
-      case GPS_SENTENCE_GPGGA:
-        time.commit();
-        if (sentenceHasFix)
+        const SentenceDescriptor &sentence = sentenceTable[curSentenceType];
+        const uint16_t committed = (this->*sentence.commit)();
+        ++(stats.*sentence.count);
+        sentenceBytes.*sentence.count += sentenceLength + endedByCr; // through the line end
+        retValue = sentence.status;
+
+        if (committed)
         {
-          location.commit();
-          altitude.commit();
+          for (uint8_t f = 0; f < TinyGPSSnapshot::FIELD_COUNT; ++f)
+            if (committed & (1u << f))
+              ++fieldCommits[f];
+          lastCommitTime = millis();
+          for (uint8_t i = 0; i < _GPS_CHANGE_TOKENS; ++i)
+            changes[i] |= committed;
+          for (TinyGPSListener *l = listeners; l != NULL; l = l->next)
+            l->onCommit(*this, committed);
         }
-        satellites.commit();
-        hdop.commit();
-        stats.gga++;
-        retValue = EncodeStatus::GGA;
-        break;
-      case GPS_SENTENCE_GPGSV:
-        satsInView.commit();
-        retValue = EncodeStatus::GSV;
-        stats.gsv++;
-        break;
-      case GPS_SENTENCE_GPVTG:
-        groundSpeed.commit();
-        retValue = EncodeStatus::VTG;
-        stats.vtg++;
-        break;
-      case GPS_SENTENCE_GPGSA:
-          gsa.commit();
-          retValue = EncodeStatus::GSA;
-          stats.gsa++;
-          break;
-      case GPS_SENTENCE_GPGLL:
-          stats.gll++;
-          retValue = EncodeStatus::GLL;
-          break;
       }
 
       // Commit all custom listeners of this sentence type
       for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0; p = p->next)
          p->commit();
+
+      if (sentenceView)
+      {
+        sentenceView->complete = true;
+        for (TinyGPSListener *l = listeners; l != NULL; l = l->next)
+          l->onSentence(*sentenceView);
+      }
       return retValue;
     }
 
@@ -271,23 +579,16 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::endOfTermHandler()
     return retValue;
   }
 
+  if (sentenceView)
+    sentenceView->append(term, curTermOffset);
+
   // the first term determines the sentence type
   if (curTermNumber == 0)
   {
-    if (!strcmp(term, _GPRMCterm) || !strcmp(term, _GNRMCterm))
-      curSentenceType = GPS_SENTENCE_GPRMC;
-    else if (!strcmp(term, _GPGGAterm) || !strcmp(term, _GNGGAterm))
-      curSentenceType = GPS_SENTENCE_GPGGA;
-    else if (!strcmp(term, _GPGSVterm))
-      curSentenceType = GPS_SENTENCE_GPGSV;
-    else if (!strcmp(term, _GPVTGterm))
-      curSentenceType = GPS_SENTENCE_GPVTG;
-    else if (!strcmp(term, _GPGSAterm))
-      curSentenceType = GPS_SENTENCE_GPGSA;
-    else if (!strcmp(term, _GPGLLterm))
-        curSentenceType = GPS_SENTENCE_GPGLL;
-    else
-      curSentenceType = GPS_SENTENCE_OTHER;
+    const SentenceName *s = sentenceNames;
+    while (s->type != GPS_SENTENCE_OTHER && strcmp(term, s->name))
+      ++s;
+    curSentenceType = s->type;
 
     // Any custom candidates of this sentence type?
     for (customCandidates = customElts; customCandidates != NULL && strcmp(customCandidates->sentenceName, term) < 0; customCandidates = customCandidates->next);
@@ -297,125 +598,289 @@ TinyGPSPlus::EncodeStatus TinyGPSPlus::endOfTermHandler()
     return retValue;
   }
 
-  if (curSentenceType != GPS_SENTENCE_OTHER && term[0])
-    switch(COMBINE(curSentenceType, curTermNumber))
+  if (term[0])
+  {
+    const uint8_t decoder = termDecoder();
+    if (!lazyDecoding)
+      decodeTerm(decoder, term);
+    else if (decoder != TERM_NONE && wantTerm(decoder))
+#if _GPS_LAZY_BUFFER_SIZE
+      storeTerm();
+#else
+      decodeTerm(decoder, term);
+#endif
+  }
+
+  // Set custom values as needed
+  for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0 && p->termNumber <= curTermNumber; p = p->next)
+    if (p->termNumber == curTermNumber)
+         p->set(term);
+
+  return retValue;
+}
+
+uint8_t TinyGPSPlus::termDecoder() const
+{
+  if (curSentenceType == GPS_SENTENCE_OTHER || curTermNumber >= _GPS_MAX_TERMS)
+    return TERM_NONE;
+  return termTable[curSentenceType][curTermNumber];
+}
+
+bool TinyGPSPlus::wantTerm(uint8_t decoder) const
+{
+  static_assert(sizeof(termFields) / sizeof(termFields[0]) == TERM_COUNT, "one termFields entry per TermDecoder");
+  return termFields[decoder] == 0 || (termFields[decoder] & decodeFields) != 0;
+}
+
+#if _GPS_LAZY_BUFFER_SIZE
+// Keeps a copy of the term for decodeStoredTerms(). Only a sentence
+// longer than NMEA allows can fill the buffer; it is then dropped, as
+// decoding the rest now would run ahead of the checksum and of the
+// stored terms.
+void TinyGPSPlus::storeTerm()
+{
+  if ((size_t)lazyLength + curTermOffset + 1 > sizeof(lazyTerms))
+  {
+    ++lazyOverflowCount;
+    lazyTermCount = 0;
+    curSentenceType = GPS_SENTENCE_OTHER; // nothing further is decoded or committed
+    return;
+  }
+  memcpy(lazyTerms + lazyLength, term, curTermOffset + 1);
+  lazyTermNumber[lazyTermCount] = curTermNumber;
+  lazyTermStart[lazyTermCount] = lazyLength;
+  ++lazyTermCount;
+  lazyLength += curTermOffset + 1;
+}
+
+void TinyGPSPlus::decodeStoredTerms()
+{
+  for (uint8_t i = 0; i < lazyTermCount; ++i)
+    decodeTerm(termTable[curSentenceType][lazyTermNumber[i]], lazyTerms + lazyTermStart[i]);
+  lazyTermCount = 0;
+}
+#endif // _GPS_LAZY_BUFFER_SIZE
+
+void TinyGPSPlus::decodeTerm(uint8_t decoder, const char *term)
+{
+  switch(decoder)
   {
-    case COMBINE(GPS_SENTENCE_GPRMC, 1): // Time in both sentences
-    case COMBINE(GPS_SENTENCE_GPGGA, 1):
+    case TERM_TIME:
       time.setTime(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 2): // GPRMC validity
+    case TERM_RMC_STATUS:
       sentenceHasFix = term[0] == 'A';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 3): // Latitude
-    case COMBINE(GPS_SENTENCE_GPGGA, 2):
+    case TERM_LAT:
       location.setLatitude(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 4): // N/S
-    case COMBINE(GPS_SENTENCE_GPGGA, 3):
+    case TERM_NS:
       location.rawNewLatData.negative = term[0] == 'S';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 5): // Longitude
-    case COMBINE(GPS_SENTENCE_GPGGA, 4):
+    case TERM_LNG:
       location.setLongitude(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 6): // E/W
-    case COMBINE(GPS_SENTENCE_GPGGA, 5):
+    case TERM_EW:
       location.rawNewLngData.negative = term[0] == 'W';
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 7): // Speed (GPRMC)
+    case TERM_SPEED:
       speed.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 8): // Course (GPRMC)
+    case TERM_COURSE:
       course.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPRMC, 9): // Date (GPRMC)
+    case TERM_DATE:
       date.setDate(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 6): // Fix data (GPGGA)
+    case TERM_GGA_QUALITY:
       sentenceHasFix = term[0] > '0';
-      if (term[0] == '1')
-      {
-          ggaFix = true;
-      }
-      else
-      {
-          ggaFix = false;
-      }
+      ggaFix = term[0] == '1';
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 7): // Satellites used (GPGGA)
+    case TERM_SATELLITES:
       satellites.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 8): // HDOP
+    case TERM_HDOP:
       hdop.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGGA, 9): // Altitude (GPGGA)
+    case TERM_ALTITUDE:
       altitude.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSV, 2): // Sentence number (GPGSV)
-      if (1 == atoi(term)) // begin new group
-      {
-          satsInView.numMsgs++;
-          satsInView.init();
-      }
+    case TERM_GSV_TOTAL:
+      satsInView.setMsgTotal(term);
+      break;
+    case TERM_GSV_NUMBER:
+      satsInView.setMsgNumber(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSV, 3): // Number of satellites (GPGSV)
+    case TERM_GSV_COUNT:
       satsInView.setNumOf(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSV, 4): // Id of Satellite @1 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 8): // Id of Satellite @2 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 12): // Id of Satellite @3 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 16): // Id of Satellite @4 (GPGSV)
+    case TERM_GSV_ID:
       satsInView.addSatId(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSV, 7): // Id of Satellite @1 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 11): // Id of Satellite @2 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 15): // Id of Satellite @3 (GPGSV)
-    case COMBINE(GPS_SENTENCE_GPGSV, 19): // Id of Satellite @4 (GPGSV)
+    case TERM_GSV_SNR:
       satsInView.addSnr(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPVTG, 7): // Ground speed km/h (GPVTG)
+    case TERM_GROUND_SPEED: // km/h
       groundSpeed.set(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 1): // Mode (GPGSA)
+    case TERM_GSA_MODE:
       gsa.init(); // new sentence begins
       gsa.setMode(term);
       gsa.amount()++;
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 2): // Fix (GPGSA)
+    case TERM_GSA_FIX:
       gsa.setFix(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 3): // Sat id @1 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 4): // Sat id @2 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 5): // Sat id @3 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 6): // Sat id @4 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 7): // Sat id @5 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 8): // Sat id @6 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 9): // Sat id @7 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 10): // Sat id @8 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 11): // Sat id @9 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 12): // Sat id @10 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 13): // Sat id @11 (GPGSA)
-    case COMBINE(GPS_SENTENCE_GPGSA, 14): // Sat id @12 (GPGSA)
+    case TERM_GSA_SAT:
       gsa.setSat(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 15): // PDOP (GPGSA)
+    case TERM_PDOP:
       gsa.setPdop(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 16): // HDOP (GPGSA)
+    case TERM_GSA_HDOP:
       gsa.setHdop(term);
       break;
-    case COMBINE(GPS_SENTENCE_GPGSA, 17): // VDOP (GPGSA)
+    case TERM_VDOP:
       gsa.setVdop(term);
       break;
+    case TERM_DAY:
+      date.setDay(term);
+      break;
+    case TERM_MONTH:
+      date.setMonth(term);
+      break;
+    case TERM_YEAR:
+      date.setYear(term);
+      break;
+    case TERM_GST_RMS:
+      gst.rms.set(term);
+      break;
+    case TERM_GST_MAJOR:
+      gst.semiMajor.set(term);
+      break;
+    case TERM_GST_MINOR:
+      gst.semiMinor.set(term);
+      break;
+    case TERM_GST_ORIENTATION:
+      gst.orientation.set(term);
+      break;
+    case TERM_GST_LAT:
+      gst.latitude.set(term);
+      break;
+    case TERM_GST_LNG:
+      gst.longitude.set(term);
+      break;
+    case TERM_GST_ALT:
+      gst.altitude.set(term);
+      break;
+    case TERM_GNS_MODE: // one character per constellation, 'N' = no fix
+      for (const char *m = term; *m; ++m)
+        if (*m != 'N')
+          sentenceHasFix = true;
+      break;
+    case TERM_TXT_TYPE:
+      txt.setType(term);
+      break;
+    case TERM_TEXT: // collected character by character, see encodeGiveStatus
+    case TERM_NONE:
+    default:
+      break;
   }
+}
 
-  // Set custom values as needed
-  for (TinyGPSCustom *p = customCandidates; p != NULL && strcmp(p->sentenceName, customCandidates->sentenceName) == 0 && p->termNumber <= curTermNumber; p = p->next)
-    if (p->termNumber == curTermNumber)
-         p->set(term);
+// Commits those of the given fields that were decoded and returns them
+uint16_t TinyGPSPlus::commitFields(uint16_t fields, bool sentenceHasDate)
+{
+  fields &= decodeFields;
+  if (fields & FIELD(DATE))
+    date.commit();
+  if (fields & FIELD(TIME))
+  {
+    time.commit();
+    timestamp.commit(date, time.time, sentenceHasDate && (fields & FIELD(DATE)), sentenceStartTime);
+  }
+  if (fields & FIELD(LOCATION))
+    location.commit();
+  if (fields & FIELD(SPEED))
+    speed.commit();
+  if (fields & FIELD(COURSE))
+    course.commit();
+  if (fields & FIELD(ALTITUDE))
+    altitude.commit();
+  if (fields & FIELD(SATELLITES))
+    satellites.commit();
+  if (fields & FIELD(HDOP))
+    hdop.commit();
+  if (fields & FIELD(GROUND_SPEED))
+    groundSpeed.commit();
+  if (fields & FIELD(GSA))
+    gsa.commit();
+  return fields;
+}
 
-  return retValue;
+uint16_t TinyGPSPlus::commitRmc()
+{
+  uint16_t fields = FIELD(DATE) | FIELD(TIME);
+  if (sentenceHasFix)
+    fields |= FIELD(LOCATION) | FIELD(SPEED) | FIELD(COURSE);
+  return commitFields(fields, true);
+}
+
+uint16_t TinyGPSPlus::commitGga()
+{
+  uint16_t fields = FIELD(TIME) | FIELD(SATELLITES) | FIELD(HDOP);
+  if (sentenceHasFix)
+    fields |= FIELD(LOCATION) | FIELD(ALTITUDE);
+  return commitFields(fields, false);
+}
+
+uint16_t TinyGPSPlus::commitGsv()
+{
+  return (decodeFields & FIELD(SATS_IN_VIEW)) && satsInView.commit() ? FIELD(SATS_IN_VIEW) : 0;
+}
+
+uint16_t TinyGPSPlus::commitVtg()
+{
+  return commitFields(FIELD(GROUND_SPEED), false);
+}
+
+uint16_t TinyGPSPlus::commitGsa()
+{
+  return commitFields(FIELD(GSA), false);
+}
+
+uint16_t TinyGPSPlus::commitGll()
+{
+  return 0;
+}
+
+uint16_t TinyGPSPlus::commitZda()
+{
+  return commitFields(FIELD(DATE) | FIELD(TIME), true);
+}
+
+uint16_t TinyGPSPlus::commitGst()
+{
+  gst.rms.commit();
+  gst.semiMajor.commit();
+  gst.semiMinor.commit();
+  gst.orientation.commit();
+  gst.latitude.commit();
+  gst.longitude.commit();
+  gst.altitude.commit();
+  return 0;
+}
+
+// Same fields as GGA, for multi-constellation receivers
+uint16_t TinyGPSPlus::commitGns()
+{
+  return commitGga();
+}
+
+uint16_t TinyGPSPlus::commitTxt()
+{
+  txt.commit();
+  return 0;
 }
 
 /* static */
@@ -426,6 +891,9 @@ double TinyGPSPlus::distanceBetween(double lat1, double long1, double lat2, doub
   // distance computation for hypothetical sphere of radius 6372795 meters.
   // Because Earth is no exact sphere, rounding errors may be up to 0.5%.
   // Courtesy of Maarten Lamers
+#ifdef _GPS_FAST_TRIG
+  return TinyGPSTrig::distanceBetween(lat1, long1, lat2, long2);
+#else
   double delta = radians(long1-long2);
   double sdlong = sin(delta);
   double cdlong = cos(delta);
@@ -442,6 +910,73 @@ double TinyGPSPlus::distanceBetween(double lat1, double long1, double lat2, doub
   double denom = (slat1 * slat2) + (clat1 * clat2 * cdlong);
   delta = atan2(delta, denom);
   return delta * 6372795;
+#endif
+}
+
+double TinyGPSPlus::distanceBetween(double lat1, double long1, double lat2, double long2, DistanceModel model)
+{
+  switch (model)
+  {
+  case DistanceModel::EQUIRECTANGULAR:
+    {
+      // One cos and one sqrt; error grows with distance and latitude span
+      double dlong = long2 - long1;
+      if (dlong > 180.0)
+        dlong -= 360.0;
+      else if (dlong < -180.0)
+        dlong += 360.0;
+      double x = radians(dlong) * cos(radians((lat1 + lat2) / 2));
+      double y = radians(lat2 - lat1);
+      return sqrt(x * x + y * y) * 6372795;
+    }
+  case DistanceModel::ELLIPSOIDAL:
+    {
+      // Vincenty inverse on WGS-84, accurate to well under a millimetre.
+      // Falls back to the sphere for nearly antipodal points where it
+      // does not converge.
+      const double a = 6378137.0;
+      const double f = 1 / 298.257223563;
+      const double b = a * (1 - f);
+      const double L = radians(long2 - long1);
+      const double U1 = atan((1 - f) * tan(radians(lat1)));
+      const double U2 = atan((1 - f) * tan(radians(lat2)));
+      const double sinU1 = sin(U1), cosU1 = cos(U1);
+      const double sinU2 = sin(U2), cosU2 = cos(U2);
+      // 1e-12 rad with 64-bit doubles; where double is float (AVR) what
+      // float can resolve, or it would never converge
+      const double tolerance = 1e-12 + 8 * DBL_EPSILON;
+      double lambda = L, lambdaPrev;
+      double sinSigma, cosSigma, sigma, cosSqAlpha, cos2SigmaM;
+      int iterations = 0;
+      do
+      {
+        const double sinLambda = sin(lambda), cosLambda = cos(lambda);
+        sinSigma = sqrt(sq(cosU2 * sinLambda) + sq(cosU1 * sinU2 - sinU1 * cosU2 * cosLambda));
+        if (sinSigma == 0)
+          return 0.0; // coincident points
+        cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+        sigma = atan2(sinSigma, cosSigma);
+        const double sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+        cosSqAlpha = 1 - sinAlpha * sinAlpha;
+        cos2SigmaM = cosSqAlpha != 0 ? cosSigma - 2 * sinU1 * sinU2 / cosSqAlpha : 0; // equatorial line
+        const double C = f / 16 * cosSqAlpha * (4 + f * (4 - 3 * cosSqAlpha));
+        lambdaPrev = lambda;
+        lambda = L + (1 - C) * f * sinAlpha * (sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM)));
+      } while (fabs(lambda - lambdaPrev) > tolerance && ++iterations < 100);
+      if (iterations >= 100)
+        return distanceBetween(lat1, long1, lat2, long2);
+
+      const double uSq = cosSqAlpha * (a * a - b * b) / (b * b);
+      const double A = 1 + uSq / 16384 * (4096 + uSq * (-768 + uSq * (320 - 175 * uSq)));
+      const double B = uSq / 1024 * (256 + uSq * (-128 + uSq * (74 - 47 * uSq)));
+      const double deltaSigma = B * sinSigma * (cos2SigmaM + B / 4 * (cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM) -
+        B / 6 * cos2SigmaM * (-3 + 4 * sinSigma * sinSigma) * (-3 + 4 * cos2SigmaM * cos2SigmaM)));
+      return b * A * (sigma - deltaSigma);
+    }
+  case DistanceModel::SPHERICAL:
+  default:
+    return distanceBetween(lat1, long1, lat2, long2);
+  }
 }
 
 double TinyGPSPlus::courseTo(double lat1, double long1, double lat2, double long2)
@@ -450,6 +985,9 @@ double TinyGPSPlus::courseTo(double lat1, double long1, double lat2, double long
   // both specified as signed decimal-degrees latitude and longitude.
   // Because Earth is no exact sphere, calculated course may be off by a tiny fraction.
   // Courtesy of Maarten Lamers
+#ifdef _GPS_FAST_TRIG
+  return TinyGPSTrig::courseTo(lat1, long1, lat2, long2);
+#else
   double dlon = radians(long2-long1);
   lat1 = radians(lat1);
   lat2 = radians(lat2);
@@ -462,6 +1000,7 @@ double TinyGPSPlus::courseTo(double lat1, double long1, double lat2, double long
     a2 += TWO_PI;
   }
   return degrees(a2);
+#endif
 }
 
 const char *TinyGPSPlus::cardinal(double course)
@@ -477,13 +1016,15 @@ const char* baudTo115200Message = {"$PUBX,41,1,0007,0003,115200,0*18"};
 void TinyGPSPlus::baudrateTo115200() const
 {
     delay(100);
-    Serial.println(baudTo115200Message);
-    delay(100);
-    Serial.end();
+    sendStringSentence(baudTo115200Message);
     delay(100);
-    Serial.begin(115200);
+    stream.setBaudrate(115200);
     delay(100);
 }
+void TinyGPSPlus::setStreamBaudrate(uint32_t baud) const
+{
+    stream.setBaudrate(baud);
+}
 void TinyGPSPlus::switchOffGsv() const
 {
     sendStringSentence(sentence_GsvOff);
@@ -503,17 +1044,16 @@ void TinyGPSPlus::periodTo100ms() const
 {
     sendByteSentence(sentence_100msPeriod, sizeof(sentence_100msPeriod));
 }
+static const uint8_t lineEnd[] = {'\r', '\n'};
 void TinyGPSPlus::sendStringSentence(const String& sentence) const
 {
-    Serial.println(sentence);
+    stream.write((const uint8_t*)sentence.c_str(), sentence.length());
+    stream.write(lineEnd, sizeof(lineEnd));
 }
 void TinyGPSPlus::sendByteSentence(const uint8_t* sentence, uint32_t const length) const
 {
-    for (int i = 0; i < length; i++)
-    {
-        Serial.write(sentence[i]);
-    }
-    Serial.println();
+    stream.write(sentence, length);
+    stream.write(lineEnd, sizeof(lineEnd));
 }
 void TinyGPSLocation::commit()
 {
@@ -560,8 +1100,50 @@ void TinyGPSTime::commit()
    lastCommitTime = millis();
    valid = updated = true;
 }
-void SatsInView::commit()
+bool SatsInView::commit()
+{
+   if (!groupIntact || msgNumber != msgExpected)
+   {
+      groupIntact = false;
+      return false;
+   }
+   if (msgNumber < groupTotal)
+   {
+      msgExpected++;
+      return false;
+   }
+   // Last message of a complete group: publish the back table
+   front = back();
+   prevSat = nullptr;
+   groupIntact = false;
+   valid = updated = true;
+   return true;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant)
+int32_t TinyGPSTimestamp::daysFromCivil(int16_t y, uint8_t m, uint8_t d)
 {
+   y -= m <= 2;
+   const int32_t era = (y >= 0 ? y : y - 399) / 400;
+   const uint16_t yoe = (uint16_t)(y - era * 400);
+   const uint16_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+   const uint32_t doe = (uint32_t)yoe * 365 + yoe / 4 - yoe / 100 + doy;
+   return era * 146097 + (int32_t)doe - 719468;
+}
+
+void TinyGPSTimestamp::commit(const TinyGPSDate &date, uint32_t time, bool hasDate, uint32_t arrival)
+{
+   if (!date.valid)
+      return;
+   const uint32_t d = date.date;
+   int32_t days = daysFromCivil(2000 + d % 100, (d / 100) % 100, d / 10000);
+   if (hasDate)
+      dateTime = time;
+   else if (time < dateTime)
+      days++; // GGA past midnight before the next RMC
+   seconds = (uint32_t)days * 86400UL + (time / 1000000) * 3600UL + ((time / 10000) % 100) * 60 + (time / 100) % 100;
+   centis = time % 100;
+   arrivalTime = arrival;
    valid = updated = true;
 }
 
@@ -573,6 +1155,22 @@ void TinyGPSDate::setDate(const char *term)
 {
    newDate = atol(term);
 }
+
+// ZDA carries day, month and year in separate terms
+void TinyGPSDate::setDay(const char *term)
+{
+   newDate = newDate % 10000 + atol(term) % 100 * 10000;
+}
+
+void TinyGPSDate::setMonth(const char *term)
+{
+   newDate = newDate / 10000 * 10000 + atol(term) % 100 * 100 + newDate % 100;
+}
+
+void TinyGPSDate::setYear(const char *term)
+{
+   newDate = newDate / 100 * 100 + atol(term) % 100;
+}
 bool TinyGPSDate::inRange()
 {
     bool retVal{true};
@@ -643,18 +1241,6 @@ uint8_t TinyGPSTime::centisecond()
    return time % 100;
 }
 
-void TinyGPSDecimal::commit()
-{
-   val = newval;
-   lastCommitTime = millis();
-   valid = updated = true;
-}
-
-void TinyGPSDecimal::set(const char *term)
-{
-   newval = TinyGPSPlus::parseDecimal(term);
-}
-
 void TinyGPSInteger::commit()
 {
    val = newval;
@@ -664,7 +1250,7 @@ void TinyGPSInteger::commit()
 
 void TinyGPSInteger::set(const char *term)
 {
-   newval = atol(term);
+   newval = (uint32_t)TinyGPSPlus::parseFixed(term, 0);
 }
 
 TinyGPSCustom::TinyGPSCustom(TinyGPSPlus &gps, const char *_sentenceName, int _termNumber)
@@ -685,6 +1271,28 @@ void TinyGPSCustom::begin(TinyGPSPlus &gps, const char *_sentenceName, int _term
    gps.insertCustom(this, _sentenceName, _termNumber);
 }
 
+void TinyGPSText::commit()
+{
+   memcpy(buffer, staging, length + 1);
+   msgType = newType;
+   lastCommitTime = millis();
+   valid = updated = true;
+}
+
+void TinyGPSText::append(char c)
+{
+   if (length < _GPS_MAX_TEXT_SIZE)
+   {
+      staging[length++] = c;
+      staging[length] = '\0';
+   }
+}
+
+void TinyGPSText::setType(const char *term)
+{
+   newType = (uint8_t)atoi(term);
+}
+
 void TinyGPSCustom::commit()
 {
    strcpy(this->buffer, this->stagingBuffer);
@@ -711,25 +1319,164 @@ void TinyGPSPlus::insertCustom(TinyGPSCustom *pElt, const char *sentenceName, in
    pElt->next = *ppelt;
    *ppelt = pElt;
 }
-SatsInView::SatsInView(): updated{false}, valid{false}, invalidSat{INVALID_ID, "0"}, numMsgs{0}
+void TinyGPSSentenceView::append(const char *term, uint8_t len)
+{
+  if (truncated || count == maxTerms || start[count] + len + 1 > textSize)
+  {
+    truncated = true;
+    return;
+  }
+  memcpy(text + start[count], term, len + 1);
+  start[count + 1] = start[count] + len + 1;
+  ++count;
+}
+
+void TinyGPSPlus::enableLazyDecoding(uint16_t fields)
+{
+  lazyDecoding = true;
+  decodeFields = fields;
+}
+
+void TinyGPSPlus::disableLazyDecoding()
+{
+  lazyDecoding = false;
+  decodeFields = (1u << TinyGPSSnapshot::FIELD_COUNT) - 1;
+}
+
+const TinyGPSPlus::ChangeToken TinyGPSPlus::NO_CHANGE_TOKEN;
+
+TinyGPSPlus::ChangeToken TinyGPSPlus::takeChangeToken()
+{
+  for (ChangeToken token = 0; token < _GPS_CHANGE_TOKENS; ++token)
+    if (!(changeTokens & (1u << token)))
+    {
+      changeTokens |= 1u << token;
+      changes[token] = 0;
+      return token;
+    }
+  return NO_CHANGE_TOKEN;
+}
+
+void TinyGPSPlus::releaseChangeToken(ChangeToken token)
+{
+  if (token < _GPS_CHANGE_TOKENS)
+    changeTokens &= ~(1u << token);
+}
+
+void TinyGPSPlus::addListener(TinyGPSListener *listener)
+{
+   listener->next = listeners;
+   listeners = listener;
+}
+
+void TinyGPSPlus::removeListener(TinyGPSListener *listener)
+{
+   for (TinyGPSListener **pp = &listeners; *pp != NULL; pp = &(*pp)->next)
+   {
+      if (*pp == listener)
+      {
+         *pp = listener->next;
+         listener->next = 0;
+         return;
+      }
+   }
+}
+
+void TinyGPSPlus::snapshot(TinyGPSSnapshot &snap) const
+{
+   memcpy(snap.version, fieldCommits, sizeof(snap.version));
+   snap.lastCommitTime = lastCommitTime;
+   snap.rawLat = location.rawLatData;
+   snap.rawLng = location.rawLngData;
+   snap.date = date.date;
+   snap.time = time.time;
+   snap.speed = speed.val;
+   snap.course = course.val;
+   snap.altitude = altitude.val;
+   snap.hdop = hdop.val;
+   snap.satellites = satellites.val;
+   snap.satsInView = satsInView.numOf();
+   snap.groundSpeed = groundSpeed.val;
+   snap.pdop = gsa.rawPdop();
+   snap.vdop = gsa.rawVdop();
+   snap.gsaHdop = gsa.rawHdop();
+   snap.gsaNumSats = gsa.numSats();
+   for (int i = 0; i < gsa.numSats(); ++i)
+      snap.gsaSatIds[i] = (uint16_t)gsa.sats()[i];
+   snap.gsaMode = gsa.mode();
+   snap.gsaFixIs3d = gsa.fixIs3d();
+}
+
+TinyGPSSnapshot::TinyGPSSnapshot()
+   : lastCommitTime(0), date(0), time(0), speed(0), course(0), altitude(0), hdop(0)
+   , satellites(0), satsInView(0), groundSpeed(0), pdop(0), vdop(0), gsaHdop(0)
+   , gsaNumSats(0), gsaMode('N'), gsaFixIs3d(false)
+{
+   memset(version, 0, sizeof(version));
+   memset(gsaSatIds, 0, sizeof(gsaSatIds));
+}
+
+double TinyGPSSnapshot::lat() const
+{
+   double ret = rawLat.deg + rawLat.billionths / 1000000000.0;
+   return rawLat.negative ? -ret : ret;
+}
+
+double TinyGPSSnapshot::lng() const
+{
+   double ret = rawLng.deg + rawLng.billionths / 1000000000.0;
+   return rawLng.negative ? -ret : ret;
+}
+
+SatsInView::SatsInView(): updated{false}, valid{false}, numSats{}, invalidSat{INVALID_ID, "0"}, prevSat{nullptr}, numMsgs{0},
+    front{0}, stagedTotal{0}, groupTotal{0}, msgNumber{0}, msgExpected{0}, groupIntact{false}
 {
+    for(SatInView& sat : sats[front])
+    {
+        sat = invalidSat;
+    }
     init();
 }
 void SatsInView::init()
 {
-    numSats = 0;
+    numSats[back()] = 0;
     prevSat = nullptr;
-    for(SatInView& sat : sats)
+    for(SatInView& sat : sats[back()])
     {
         sat = invalidSat;
     }
 }
+void SatsInView::setMsgTotal(const char *term)
+{
+    stagedTotal = atoi(term);
+}
+void SatsInView::setMsgNumber(const char *term)
+{
+    msgNumber = atoi(term);
+    if (1 == msgNumber) // begin new group
+    {
+        numMsgs++;
+        init();
+        groupTotal = stagedTotal;
+        msgExpected = 1;
+        groupIntact = groupTotal > 0;
+    }
+    else if (msgNumber != msgExpected || stagedTotal != groupTotal)
+    {
+        groupIntact = false;
+    }
+    stagedTotal = 0;
+}
 void SatsInView::setNumOf(const char *term)
 {
-    numSats = atoi(term);
+    numSats[back()] = atoi(term);
 }
 void SatsInView::addSatId(const char *term)
 {
+    if (!groupIntact)
+    {
+        return;
+    }
     const int id = atoi(term);
     SatInView& sat = findSat(id);
     sat.id() = id;
@@ -741,8 +1488,8 @@ SatsInView::SatInView& SatsInView::findSat(const int id)
 }
 SatsInView::SatInView* SatsInView::findNewSat(const int id)
 {
-    prevSat = &sats[0];
-    for(SatInView& sat : sats)
+    prevSat = &sats[back()][0];
+    for(SatInView& sat : sats[back()])
     {
 
         if(sat.id() == INVALID_ID)
@@ -755,7 +1502,7 @@ SatsInView::SatInView* SatsInView::findNewSat(const int id)
 }
 void SatsInView::addSnr(const char *term)
 {
-    if (prevSat)
+    if (groupIntact and prevSat)
     {
         prevSat->snr() = STRING{term};
     }
@@ -763,7 +1510,7 @@ void SatsInView::addSnr(const char *term)
 unsigned int SatsInView::numOfDb() const
 {
     unsigned int total = 0;
-    for(const SatInView& sat : sats)
+    for(const SatInView& sat : sats[front])
     {
         if(sat.id() != INVALID_ID)
         {
@@ -775,7 +1522,7 @@ unsigned int SatsInView::numOfDb() const
 unsigned int SatsInView::totalSnr() const
 {
     unsigned int total = 0;
-    for(const SatInView& sat : sats)
+    for(const SatInView& sat : sats[front])
     {
         if(sat.id() != INVALID_ID)
         {
@@ -793,7 +1540,7 @@ unsigned int SatsInView::SatInView::snrInt() const
 }
 void GroundSpeed::set(const char* term)
 {
-    val = atof(term);
+    val = TinyGPSPlus::parseFixed(term, Fixed::decimals);
 }
 void Gsa::setMode(const char* term)
 {
@@ -825,15 +1572,15 @@ void Gsa::setFix(const char* term)
 }
 void Gsa::setPdop(const char* term)
 {
-    pdop_ = atof(term);
+    pdop_ = TinyGPSPlus::parseFixed(term, Fixed::decimals);
 }
 void Gsa::setVdop(const char* term)
 {
-    vdop_ = atof(term);
+    vdop_ = TinyGPSPlus::parseFixed(term, Fixed::decimals);
 }
 void Gsa::setHdop(const char* term)
 {
-    hdop_ = atof(term);
+    hdop_ = TinyGPSPlus::parseFixed(term, Fixed::decimals);
 }
 void Gsa::setSat(const char* term)
 {
@@ -849,9 +1596,9 @@ void Gsa::init()
     updated = false;
     valid = false;
     numSats_ = 0;
-    pdop_ = 0.0;
-    vdop_ = 0.0;
-    hdop_ = 0.0;
+    pdop_ = 0;
+    vdop_ = 0;
+    hdop_ = 0;
     fix_ = fixNotApplicable;
     mode_ = "N"[0];
 }
@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define __TinyGPSPlus_h
 
 #include "Arduino.h"
+#include "TinyGPSStream.h"
 #include <limits.h>
 
 #define _GPS_VERSION "1.0.2" // software version of this library
@@ -35,6 +36,56 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #define _GPS_KM_PER_METER 0.001
 #define _GPS_FEET_PER_METER 3.2808399
 #define _GPS_MAX_FIELD_SIZE 15
+// Decimal places kept per field; terms are rounded to these. Raising
+// one changes the unit of that field's value().
+#ifndef _GPS_SPEED_DECIMALS
+#define _GPS_SPEED_DECIMALS 2
+#endif
+#ifndef _GPS_COURSE_DECIMALS
+#define _GPS_COURSE_DECIMALS 2
+#endif
+#ifndef _GPS_ALTITUDE_DECIMALS
+#define _GPS_ALTITUDE_DECIMALS 2
+#endif
+#ifndef _GPS_DOP_DECIMALS
+#define _GPS_DOP_DECIMALS 2
+#endif
+#ifndef _GPS_GROUND_SPEED_DECIMALS
+#define _GPS_GROUND_SPEED_DECIMALS 3
+#endif
+#define _GPS_MAX_TERMS 20 // highest decoded term number + 1 (GSV)
+#ifndef _GPS_MAX_TEXT_SIZE // longer TXT messages are truncated; two buffers of this + 1
+#define _GPS_MAX_TEXT_SIZE 64
+#endif
+#define _GPS_CHANGE_TOKENS 4 // consumers tracking changes with changedSince()
+// Terms held for lazy decoding; NMEA caps a sentence at 82 chars. 0
+// leaves the buffer out: lazy decoding then only skips unwanted fields
+// and decodes the rest as they arrive.
+#ifndef _GPS_LAZY_BUFFER_SIZE
+#if defined(__AVR__)
+#define _GPS_LAZY_BUFFER_SIZE 0
+#else
+#define _GPS_LAZY_BUFFER_SIZE 82
+#endif
+#endif
+// 1 assembles each GSV group apart and publishes it whole; 0 halves the
+// satellite table, and a group shows as its messages arrive.
+#ifndef _GPS_SATS_BACK_BUFFER
+#if defined(__AVR__)
+#define _GPS_SATS_BACK_BUFFER 0
+#else
+#define _GPS_SATS_BACK_BUFFER 1
+#endif
+#endif
+#ifndef _GPS_RX_BUFFER_SIZE // bytes fetched from the stream per read
+#if defined(__AVR__)
+#define _GPS_RX_BUFFER_SIZE 16
+#elif defined(__linux__)
+#define _GPS_RX_BUFFER_SIZE 4096
+#else
+#define _GPS_RX_BUFFER_SIZE 128
+#endif
+#endif
 
 struct RawDegrees
 {
@@ -49,12 +100,19 @@ public:
 struct TinyGPSLocation
 {
    friend class TinyGPSPlus;
+   friend class TinyGPSWriter;
+   friend class TinyGPSTrack;
+   friend class TinyGPSTrip;
+   friend class TinyGPSColumnExport;
 public:
    bool isValid() const    { return valid; }
    bool isUpdated() const  { return updated; }
    uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
    const RawDegrees &rawLat()     { updated = false; return rawLatData; }
    const RawDegrees &rawLng()     { updated = false; return rawLngData; }
+   // As above, leaving isUpdated() alone
+   const RawDegrees &peekLat() const { return rawLatData; }
+   const RawDegrees &peekLng() const { return rawLngData; }
    double lat();
    double lng();
 
@@ -73,12 +131,15 @@ private:
 struct TinyGPSDate
 {
    friend class TinyGPSPlus;
+   friend class TinyGPSWriter;
+   friend struct TinyGPSTimestamp;
 public:
    bool isValid() const       { return valid; }
    bool isUpdated() const     { return updated; }
    uint32_t age() const       { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
 
    uint32_t value()           { updated = false; return date; }
+   uint32_t peek() const      { return date; } // value() leaving isUpdated() alone
    uint16_t year();
    uint8_t month();
    uint8_t day();
@@ -93,17 +154,24 @@ private:
    uint32_t lastCommitTime;
    void commit();
    void setDate(const char *term);
+   void setDay(const char *term);
+   void setMonth(const char *term);
+   void setYear(const char *term);
 };
 
 struct TinyGPSTime
 {
    friend class TinyGPSPlus;
+   friend class TinyGPSWriter;
+   friend class TinyGPSTrack;
+   friend class TinyGPSTrip;
 public:
    bool isValid() const       { return valid; }
    bool isUpdated() const     { return updated; }
    uint32_t age() const       { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
 
    uint32_t value()           { updated = false; return time; }
+   uint32_t peek() const      { return time; } // value() leaving isUpdated() alone
    uint8_t hour();
    uint8_t minute();
    uint8_t second();
@@ -121,36 +189,87 @@ private:
    void setTime(const char *term);
 };
 
-struct TinyGPSDecimal
+// UTC of the last RMC/GGA as Unix time, computed once per commit
+struct TinyGPSTimestamp
 {
    friend class TinyGPSPlus;
+   friend class TinyGPSClock;
+   friend class TinyGPSColumnExport;
 public:
+   bool isValid() const       { return valid; }
+   bool isUpdated() const     { return updated; }
+   uint32_t age() const       { return valid ? millis() - arrivalTime : (uint32_t)ULONG_MAX; }
+
+   uint32_t unixSeconds()     { updated = false; return seconds; }
+   uint8_t centisecond()      { updated = false; return centis; }
+   uint64_t unixMillis()      { updated = false; return (uint64_t)seconds * 1000 + centis * 10; }
+   // millis() when the bytes holding the sentence's '$' were read, or
+   // parsed if no read time was given. Sentences read in one batch share
+   // it, and it does not include time spent in UART or driver buffers.
+   uint32_t arrival() const   { return arrivalTime; }
+
+   TinyGPSTimestamp() : valid(false), updated(false), seconds(0), centis(0), arrivalTime(0), dateTime(0)
+   {}
+   static int32_t daysFromCivil(int16_t y, uint8_t m, uint8_t d);
+
+private:
+   bool valid, updated;
+   uint32_t seconds;
+   uint8_t centis;
+   uint32_t arrivalTime;
+   uint32_t dateTime; // time of day of the last sentence that carried the date
+   void commit(const TinyGPSDate &date, uint32_t time, bool hasDate, uint32_t arrival);
+};
+
+// Fixed-point decimal: value() is the term times 10^Decimals, rounded.
+// Every decimal field has this layout; doubles only appear in the
+// unit accessors of the derived types.
+template <uint8_t Decimals>
+struct TinyGPSFixed
+{
+   friend class TinyGPSPlus;
+   friend class TinyGPSWriter;
+   friend class TinyGPSTrip;
+   friend class TinyGPSColumnExport;
+public:
+   static const uint8_t decimals = Decimals;
+   static constexpr int32_t pow10(uint8_t n) { return n ? 10 * pow10(n - 1) : 1; }
+
    bool isValid() const    { return valid; }
    bool isUpdated() const  { return updated; }
    uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
    int32_t value()         { updated = false; return val; }
+   int32_t peek() const    { return val; } // value() leaving isUpdated() alone
+   double toDouble()       { return value() / (double)pow10(Decimals); }
 
-   TinyGPSDecimal() : valid(false), updated(false), val(0)
+   TinyGPSFixed() : valid(false), updated(false), val(0), newval(0)
    {}
 
 private:
    bool valid, updated;
    uint32_t lastCommitTime;
    int32_t val, newval;
-   void commit();
+   void commit() { val = newval; lastCommitTime = millis(); valid = updated = true; }
    void set(const char *term);
+   int32_t in(uint8_t targetDecimals) const; // val rescaled, for friends
 };
+template <uint8_t Decimals> const uint8_t TinyGPSFixed<Decimals>::decimals;
+
+typedef TinyGPSFixed<2> TinyGPSDecimal;
 
 struct TinyGPSInteger
 {
    friend class TinyGPSPlus;
+   friend class TinyGPSWriter;
+   friend class TinyGPSColumnExport;
 public:
    bool isValid() const    { return valid; }
    bool isUpdated() const  { return updated; }
    uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
    uint32_t value()        { updated = false; return val; }
+   uint32_t peek() const   { return val; } // value() leaving isUpdated() alone
 
-   TinyGPSInteger() : valid(false), updated(false), val(0)
+   TinyGPSInteger() : valid(false), updated(false), val(0), newval(0)
    {}
 
 private:
@@ -161,30 +280,70 @@ private:
    void set(const char *term);
 };
 
-struct TinyGPSSpeed : TinyGPSDecimal
+struct TinyGPSSpeed : TinyGPSFixed<_GPS_SPEED_DECIMALS>
+{
+   double knots()    { return toDouble(); }
+   double mph()      { return _GPS_MPH_PER_KNOT * toDouble(); }
+   double mps()      { return _GPS_MPS_PER_KNOT * toDouble(); }
+   double kmph()     { return _GPS_KMPH_PER_KNOT * toDouble(); }
+};
+
+struct TinyGPSCourse : public TinyGPSFixed<_GPS_COURSE_DECIMALS>
 {
-   double knots()    { return value() / 100.0; }
-   double mph()      { return _GPS_MPH_PER_KNOT * value() / 100.0; }
-   double mps()      { return _GPS_MPS_PER_KNOT * value() / 100.0; }
-   double kmph()     { return _GPS_KMPH_PER_KNOT * value() / 100.0; }
+   double deg()      { return toDouble(); }
 };
 
-struct TinyGPSCourse : public TinyGPSDecimal
+struct TinyGPSAltitude : TinyGPSFixed<_GPS_ALTITUDE_DECIMALS>
 {
-   double deg()      { return value() / 100.0; }
+   double meters()       { return toDouble(); }
+   double miles()        { return _GPS_MILES_PER_METER * toDouble(); }
+   double kilometers()   { return _GPS_KM_PER_METER * toDouble(); }
+   double feet()         { return _GPS_FEET_PER_METER * toDouble(); }
 };
 
-struct TinyGPSAltitude : TinyGPSDecimal
+struct TinyGPSHDOP : TinyGPSFixed<_GPS_DOP_DECIMALS>
 {
-   double meters()       { return value() / 100.0; }
-   double miles()        { return _GPS_MILES_PER_METER * value() / 100.0; }
-   double kilometers()   { return _GPS_KM_PER_METER * value() / 100.0; }
-   double feet()         { return _GPS_FEET_PER_METER * value() / 100.0; }
+   double hdop() { return toDouble(); }
 };
 
-struct TinyGPSHDOP : TinyGPSDecimal
+// GST pseudorange error statistics; all values in hundredths of a
+// metre except orientation, which is in hundredths of a degree
+struct TinyGPSErrorEstimate
 {
-   double hdop() { return value() / 100.0; }
+   TinyGPSDecimal rms;
+   TinyGPSDecimal semiMajor;
+   TinyGPSDecimal semiMinor;
+   TinyGPSDecimal orientation;
+   TinyGPSDecimal latitude;
+   TinyGPSDecimal longitude;
+   TinyGPSDecimal altitude;
+};
+
+// Last TXT message; multi-part messages are not joined
+struct TinyGPSText
+{
+   friend class TinyGPSPlus;
+public:
+   bool isValid() const    { return valid; }
+   bool isUpdated() const  { return updated; }
+   uint32_t age() const    { return valid ? millis() - lastCommitTime : (uint32_t)ULONG_MAX; }
+   const char *value()     { updated = false; return buffer; }
+   uint8_t type() const    { return msgType; } // 0 error, 1 warning, 2 notice, 7 user
+
+   TinyGPSText() : valid(false), updated(false), msgType(0), newType(0), length(0)
+   { buffer[0] = staging[0] = '\0'; }
+
+private:
+   bool valid, updated;
+   uint8_t msgType, newType;
+   uint8_t length;
+   char buffer[_GPS_MAX_TEXT_SIZE + 1];
+   char staging[_GPS_MAX_TEXT_SIZE + 1];
+   uint32_t lastCommitTime;
+   void commit();
+   void begin() { length = 0; staging[0] = '\0'; }
+   void append(char c);
+   void setType(const char *term);
 };
 
 class TinyGPSPlus;
@@ -214,6 +373,49 @@ private:
    TinyGPSCustom *next;
 };
 
+// Read-only view of the last sentence that passed its checksum, for
+// sentences without a decoder such as $PUBX. Terms are NUL-terminated
+// and indexed in O(1); term 0 is the address ("PUBX"), the checksum is
+// not included. The contents are valid until the next '$' arrives.
+class TinyGPSSentenceView
+{
+public:
+   bool isValid() const               { return complete; }
+   bool isTruncated() const           { return truncated; } // terms beyond the buffer were dropped
+   uint8_t size() const               { return count; }
+   const char *operator[](uint8_t i) const { return i < count ? text + start[i] : ""; }
+   uint8_t length(uint8_t i) const    { return i < count ? start[i + 1] - start[i] - 1 : 0; }
+
+protected:
+   TinyGPSSentenceView(char *_text, uint16_t _textSize, uint16_t *_start, uint8_t _maxTerms)
+      : text(_text), start(_start), textSize(_textSize), maxTerms(_maxTerms), count(0), complete(false), truncated(false)
+   { start[0] = 0; }
+
+private:
+   friend class TinyGPSPlus;
+   void clear() { count = 0; complete = truncated = false; }
+   void append(const char *term, uint8_t len);
+
+   char *text;
+   uint16_t *start; // maxTerms + 1 entries; start[count] is the end
+   uint16_t textSize;
+   uint8_t maxTerms;
+   uint8_t count;
+   bool complete, truncated;
+};
+
+// Storage for a TinyGPSSentenceView. $PUBX,00 needs about 120 chars and
+// 21 terms; $PUBX,03 grows by 6 terms per satellite.
+template <uint16_t Chars = 128, uint8_t Terms = 32>
+class TinyGPSSentenceBuffer : public TinyGPSSentenceView
+{
+public:
+   TinyGPSSentenceBuffer() : TinyGPSSentenceView(buffer, Chars, offsets, Terms) {}
+private:
+   char buffer[Chars];
+   uint16_t offsets[Terms + 1];
+};
+
 typedef std::string STRING;
 static const unsigned int MAX_SATS{30};
 class SatsInView
@@ -240,52 +442,69 @@ public:
     bool isUpdated() const { return updated; }
     bool isValid() const { return valid; }
     unsigned int messageAmount() const { return numMsgs; }
-    unsigned int numOf() const { return numSats; }
+    unsigned int numOf() const { return numSats[front]; }
     unsigned int numOfDb() const;
-    void commit();
+    bool commit();
     const SatInView& operator[](const int i) const
     {
         if (i < MAX_SATS)
         {
-            return sats[i];
+            return sats[front][i];
         }
         return invalidSat;
     }
     SatInView& findSat(const int id);
+    void setMsgTotal(const char *term);
+    void setMsgNumber(const char *term);
     void setNumOf(const char *term);
     void addSatId(const char *term);
     void addSnr(const char *term);
     unsigned int totalSnr() const;
 private:
+    // A GSV group is assembled into the back table and published by
+    // flipping 'front' once its last message has passed the checksum.
+    // Without a back buffer both are the one table.
+    unsigned int back() const { return _GPS_SATS_BACK_BUFFER ? front ^ 1 : front; }
     SatInView* findNewSat(const int id);
     bool updated;
     bool valid;
-    unsigned int numSats;
-    SatInView sats[MAX_SATS];
+    unsigned int numSats[1 + _GPS_SATS_BACK_BUFFER];
+    SatInView sats[1 + _GPS_SATS_BACK_BUFFER][MAX_SATS];
     const SatInView invalidSat;
     SatInView* prevSat;
     unsigned int numMsgs;
+    uint8_t front;
+    uint8_t stagedTotal;
+    uint8_t groupTotal;
+    uint8_t msgNumber;
+    uint8_t msgExpected;
+    bool groupIntact;
 };
 
+// Speed over ground from VTG in km/h
 class GroundSpeed
 {
+    friend class TinyGPSPlus;
 public:
-    GroundSpeed(): updated{false}, valid{false}, val{0.0}{}
+    typedef TinyGPSFixed<_GPS_GROUND_SPEED_DECIMALS> Fixed;
+    GroundSpeed(): updated{false}, valid{false}, val{0}{}
     bool isUpdated() const { return updated; }
     bool isValid() const { return valid; }
     void commit() { updated = valid = true;}
-    double value() { updated = false; return val; }
+    double value() { updated = false; return val / (double)Fixed::pow10(Fixed::decimals); }
+    int32_t raw() const { return val; } // km/h * 10^Fixed::decimals
     void set(const char*);
 private:
     bool updated;
     bool valid;
-    double val;
+    int32_t val;
 };
 
 class Gsa
 {
 public:
-    Gsa(): updated{false}, valid{false}, numSats_{0}, pdop_{0.0}, vdop_{0.0}, hdop_{0.0}, fix_{}, mode_{}, amount_{}
+    typedef TinyGPSFixed<_GPS_DOP_DECIMALS> Fixed;
+    Gsa(): updated{false}, valid{false}, numSats_{0}, pdop_{0}, vdop_{0}, hdop_{0}, fix_{}, mode_{}, amount_{}
     {
         init();
     }
@@ -297,9 +516,13 @@ public:
     bool fixIs3d() const;
     const char mode() const { return mode_; }
     int numSats() const { return numSats_; }
-    double pdop() const { return pdop_; };
-    double vdop() const { return vdop_; };
-    double hdop() const { return hdop_; };
+    double pdop() const { return pdop_ / (double)Fixed::pow10(Fixed::decimals); };
+    double vdop() const { return vdop_ / (double)Fixed::pow10(Fixed::decimals); };
+    double hdop() const { return hdop_ / (double)Fixed::pow10(Fixed::decimals); };
+    // DOP * 10^Fixed::decimals
+    int32_t rawPdop() const { return pdop_; }
+    int32_t rawVdop() const { return vdop_; }
+    int32_t rawHdop() const { return hdop_; }
     void setMode(const char*);
     void setFix(const char*);
     void setPdop(const char*);
@@ -314,7 +537,7 @@ private:
     bool valid;
     int numSats_;
     int satId[MAX_SATS];
-    double pdop_, vdop_, hdop_;
+    int32_t pdop_, vdop_, hdop_;
     static const char fixNone[];
     static const char fixNotApplicable[];
     static const char fix2d[];
@@ -324,6 +547,64 @@ private:
     int amount_;
 };
 
+// Plain copy of the committed parser state, suitable for handing to
+// other threads. version[] counts the parser's commits per field; 0
+// means never valid. lastCommitTime is millis() at the latest commit.
+struct TinyGPSSnapshot
+{
+   enum Field
+   {
+      LOCATION,
+      DATE,
+      TIME,
+      SPEED,
+      COURSE,
+      ALTITUDE,
+      SATELLITES,
+      HDOP,
+      SATS_IN_VIEW,
+      GROUND_SPEED,
+      GSA,
+      FIELD_COUNT
+   };
+   TinyGPSSnapshot();
+   bool isValid(Field f) const { return version[f] != 0; }
+   double lat() const;
+   double lng() const;
+
+   uint32_t version[FIELD_COUNT];
+   uint32_t lastCommitTime;
+   RawDegrees rawLat, rawLng;
+   uint32_t date, time;
+   // fixed-point values, scaled as the TinyGPSPlus field they come from
+   int32_t speed, course, altitude, hdop;
+   uint32_t satellites;
+   uint32_t satsInView;
+   int32_t groundSpeed;
+   int32_t pdop, vdop, gsaHdop;
+   int gsaNumSats;
+   uint16_t gsaSatIds[MAX_SATS]; // the first gsaNumSats are used
+   char gsaMode;
+   bool gsaFixIs3d;
+};
+
+// Receives a callback after every sentence that committed fields.
+// 'fields' is a bitmask of (1 << TinyGPSSnapshot::Field).
+class TinyGPSListener
+{
+public:
+   TinyGPSListener() : next(0) {}
+   virtual ~TinyGPSListener() {}
+   virtual void onCommit(const TinyGPSPlus &gps, uint16_t fields) = 0;
+   // UBX-ACK-ACK (ack) or UBX-ACK-NAK for the message msgClass/msgId
+   virtual void onUbxAck(uint8_t /*msgClass*/, uint8_t /*msgId*/, bool /*ack*/) {}
+   // Every sentence that passed its checksum, while a view is attached
+   virtual void onSentence(const TinyGPSSentenceView & /*sentence*/) {}
+private:
+   friend class TinyGPSPlus;
+   TinyGPSListener *next;
+};
+
 class TinyGPSPlus
 {
 public:
@@ -336,18 +617,28 @@ public:
       GSV = 4,
       VTG = 5,
       GSA = 6,
-      GLL = 7
+      GLL = 7,
+      ZDA = 8,
+      GST = 9,
+      GNS = 10,
+      TXT = 11
   };
-  TinyGPSPlus();
+  TinyGPSPlus(); // talks to the global Serial
+  explicit TinyGPSPlus(TinyGPSStream &stream);
   bool readSerial();
   bool encode(char c); // process one character received from GPS
   EncodeStatus readSerialGiveStatus();
   EncodeStatus encodeGiveStatus(char c); // process one character received from GPS
+  EncodeStatus encodeGiveStatus(const char *buf, size_t len, size_t &consumed); // process until a status or end of buffer
+  // The same for bytes read at millis() readTime, which sentences starting
+  // in them take as their arrival; readSerial() passes its read times
+  EncodeStatus encodeGiveStatus(const char *buf, size_t len, size_t &consumed, uint32_t readTime);
   TinyGPSPlus &operator << (char c) {encode(c); return *this;}
 
   TinyGPSLocation location;
   TinyGPSDate date;
   TinyGPSTime time;
+  TinyGPSTimestamp timestamp;
   TinyGPSSpeed speed;
   TinyGPSCourse course;
   TinyGPSAltitude altitude;
@@ -356,6 +647,8 @@ public:
   SatsInView satsInView;
   GroundSpeed groundSpeed;
   Gsa gsa;
+  TinyGPSErrorEstimate gst;
+  TinyGPSText txt;
   bool ggaFix;
   struct Stats
   {
@@ -365,8 +658,22 @@ public:
       unsigned int gsv{};
       unsigned int gll{};
       unsigned int vtg{};
+      unsigned int zda{};
+      unsigned int gst{};
+      unsigned int gns{};
+      unsigned int txt{};
   };
   Stats stats;
+  Stats sentenceBytes; // bytes of valid sentences, per type
+  // Framing errors; each one drops the sentence and skips to the next '$'
+  struct Corruption
+  {
+      unsigned int overlongTerm{};
+      unsigned int nonPrintable{};
+      unsigned int missingChecksum{};
+      unsigned int truncated{};
+  };
+  Corruption corruption;
 
   const String sentence_GsvOff;
   const String sentence_GsvOn;
@@ -381,18 +688,59 @@ public:
 
   static const char *libraryVersion() { return _GPS_VERSION; }
 
+  void addListener(TinyGPSListener *listener);
+  // A listener that goes away before the parser must be removed first
+  void removeListener(TinyGPSListener *listener);
+  void snapshot(TinyGPSSnapshot &snap) const;
+
+  // Lazy decoding: terms are only stored while a sentence arrives and
+  // are decoded once its checksum passes, and then only those feeding
+  // the given fields (bitmask of 1 << TinyGPSSnapshot::Field). Other
+  // fields are neither decoded nor committed. GST and TXT are always
+  // decoded. With _GPS_LAZY_BUFFER_SIZE 0 the wanted terms are decoded
+  // as they arrive.
+  void enableLazyDecoding(uint16_t fields = (1u << TinyGPSSnapshot::FIELD_COUNT) - 1);
+  void disableLazyDecoding();
+
+  // Change tracking: a token collects the fields (bitmask of
+  // 1 << TinyGPSSnapshot::Field) committed since it was taken or last
+  // acknowledged. Querying is one load and clears nothing; read the
+  // fields with snapshot() or the peek() accessors, then acknowledge.
+  typedef uint8_t ChangeToken;
+  static const ChangeToken NO_CHANGE_TOKEN = 0xFF; // all tokens taken; reports every field as changed
+  ChangeToken takeChangeToken();
+  void releaseChangeToken(ChangeToken token);
+  uint16_t changedSince(ChangeToken token) const
+  { return token < _GPS_CHANGE_TOKENS ? changes[token] : (1u << TinyGPSSnapshot::FIELD_COUNT) - 1; }
+  void acknowledge(ChangeToken token, uint16_t fields = 0xFFFF)
+  { if (token < _GPS_CHANGE_TOKENS) changes[token] &= ~fields; }
+
+  // Fills the view with each sentence; nullptr detaches it
+  void setSentenceView(TinyGPSSentenceView *view) { sentenceView = view; }
+
+  enum class DistanceModel
+  {
+      EQUIRECTANGULAR = 0, // flat-earth; cheapest, for short ranges
+      SPHERICAL = 1,       // great circle, radius 6372795 m
+      ELLIPSOIDAL = 2      // WGS-84, Vincenty inverse
+  };
   static double distanceBetween(double lat1, double long1, double lat2, double long2);
+  static double distanceBetween(double lat1, double long1, double lat2, double long2, DistanceModel model);
   static double courseTo(double lat1, double long1, double lat2, double long2);
   static const char *cardinal(double course);
 
-  static int32_t parseDecimal(const char *term);
+  static int32_t parseDecimal(const char *term); // hhmmss.cc style, truncates to 2 decimals
+  static int32_t parseFixed(const char *term, uint8_t decimals); // rounds
+  static int32_t rescale(int32_t value, uint8_t from, uint8_t to); // rounds
   static void parseDegrees(const char *term, RawDegrees &deg);
 
   uint32_t charsProcessed()   const { return encodedCharCount; }
   uint32_t sentencesWithFix() const { return sentencesWithFixCount; }
   uint32_t failedChecksum()   const { return failedChecksumCount; }
   uint32_t passedChecksum()   const { return passedChecksumCount; }
-  void baudrateTo115200() const;
+  uint32_t lazyOverflows()    const { return lazyOverflowCount; } // sentences dropped: too long for the lazy buffer
+  void baudrateTo115200() const; // blocks ~300 ms; see TinyGPSCommands for a non-blocking queue
+  void setStreamBaudrate(uint32_t baud) const; // local side only
   void switchOffGsv() const;
   void setMinimumNmeaSentences() const;
   void periodTo5000ms() const;
@@ -401,7 +749,41 @@ public:
   void sendByteSentence(const uint8_t* sentence, uint32_t const length) const;
 
 private:
-  enum {GPS_SENTENCE_GPGGA, GPS_SENTENCE_GPRMC, GPS_SENTENCE_GPGSV, GPS_SENTENCE_GPVTG, GPS_SENTENCE_GPGSA, GPS_SENTENCE_GPGLL, GPS_SENTENCE_OTHER};
+  enum {GPS_SENTENCE_GPGGA, GPS_SENTENCE_GPRMC, GPS_SENTENCE_GPGSV, GPS_SENTENCE_GPVTG, GPS_SENTENCE_GPGSA, GPS_SENTENCE_GPGLL,
+        GPS_SENTENCE_ZDA, GPS_SENTENCE_GST, GPS_SENTENCE_GNS, GPS_SENTENCE_TXT, GPS_SENTENCE_OTHER};
+
+  // Term decoders; the descriptor tables map each term number to one
+  enum TermDecoder : uint8_t
+  {
+    TERM_NONE, TERM_TIME, TERM_RMC_STATUS, TERM_LAT, TERM_NS, TERM_LNG, TERM_EW,
+    TERM_SPEED, TERM_COURSE, TERM_DATE, TERM_GGA_QUALITY, TERM_SATELLITES, TERM_HDOP, TERM_ALTITUDE,
+    TERM_GSV_TOTAL, TERM_GSV_NUMBER, TERM_GSV_COUNT, TERM_GSV_ID, TERM_GSV_SNR,
+    TERM_GROUND_SPEED, TERM_GSA_MODE, TERM_GSA_FIX, TERM_GSA_SAT, TERM_PDOP, TERM_GSA_HDOP, TERM_VDOP,
+    TERM_DAY, TERM_MONTH, TERM_YEAR,
+    TERM_GST_RMS, TERM_GST_MAJOR, TERM_GST_MINOR, TERM_GST_ORIENTATION, TERM_GST_LAT, TERM_GST_LNG, TERM_GST_ALT,
+    TERM_GNS_MODE, TERM_TXT_TYPE, TERM_TEXT, TERM_COUNT
+  };
+  struct SentenceDescriptor
+  {
+    EncodeStatus status;
+    unsigned int Stats::*count;
+    uint16_t (TinyGPSPlus::*commit)(); // returns the committed TinyGPSSnapshot fields
+  };
+  struct SentenceName
+  {
+    char name[6];
+    uint8_t type;
+  };
+  static const uint8_t termTable[GPS_SENTENCE_OTHER][_GPS_MAX_TERMS]; // TermDecoder per term number
+  static const SentenceDescriptor sentenceTable[GPS_SENTENCE_OTHER];
+  static const SentenceName sentenceNames[];
+  static const uint16_t termFields[]; // TinyGPSSnapshot fields fed by each decoder; 0 = always decoded
+
+  // receiver I/O
+  TinyGPSStream &stream;
+  uint8_t rxBuffer[_GPS_RX_BUFFER_SIZE];
+  size_t rxHead, rxTail;
+  uint32_t rxTime; // millis() of the read that filled rxBuffer
 
   // parsing state variables
   uint8_t parity;
@@ -411,6 +793,28 @@ private:
   uint8_t curTermNumber;
   uint8_t curTermOffset;
   bool sentenceHasFix;
+  bool inSentence;
+  bool isTextTerm;
+  bool endedByCr;     // the sentence ended in CR, so an LF follows
+  uint16_t sentenceLength;
+  uint32_t sentenceStartTime;
+  bool hasReadTime;   // while encoding bytes with a read time
+  uint32_t readTime;
+
+  // lazy decoding: terms of the current sentence, NUL-separated
+  bool lazyDecoding;
+  uint16_t decodeFields; // all fields unless lazy
+  bool wantTerm(uint8_t decoder) const;
+#if _GPS_LAZY_BUFFER_SIZE
+  static_assert(_GPS_LAZY_BUFFER_SIZE <= 255, "lazy term offsets are 8-bit");
+  static_assert(_GPS_LAZY_BUFFER_SIZE >= 82, "the lazy buffer must hold a sentence of NMEA's maximum length");
+  char lazyTerms[_GPS_LAZY_BUFFER_SIZE];
+  uint8_t lazyLength;
+  uint8_t lazyTermCount;
+  uint8_t lazyTermNumber[_GPS_MAX_TERMS], lazyTermStart[_GPS_MAX_TERMS];
+  void storeTerm();
+  void decodeStoredTerms();
+#endif
 
   // custom element support
   friend class TinyGPSCustom;
@@ -418,15 +822,64 @@ private:
   TinyGPSCustom *customCandidates;
   void insertCustom(TinyGPSCustom *pElt, const char *sentenceName, int index);
 
+  // commit listeners
+  TinyGPSListener *listeners;
+  uint32_t fieldCommits[TinyGPSSnapshot::FIELD_COUNT]; // the snapshot's version[]
+  uint32_t lastCommitTime;                             // millis() of the last commit
+  uint16_t changes[_GPS_CHANGE_TOKENS];
+  uint8_t changeTokens; // bit per token in use
+  TinyGPSSentenceView *sentenceView;
+
   // statistics
   uint32_t encodedCharCount;
   uint32_t sentencesWithFixCount;
   uint32_t failedChecksumCount;
   uint32_t passedChecksumCount;
+  uint32_t lazyOverflowCount;
+
+  // UBX frames between sentences; only ACK-ACK/NAK are decoded
+  uint8_t ubxState;
+  uint8_t ubxClass, ubxId;
+  uint16_t ubxLength, ubxOffset;
+  uint8_t ubxCkA, ubxCkB;
+  uint8_t ubxPayload[2];
+  void ubxByte(uint8_t b);
+  void ubxFrame(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length);
+
+  // TinyGPSDemux does the framing itself: it hands over sentences only
+  // and verified UBX frames
+  friend class TinyGPSDemux;
+  EncodeStatus encodeSentence(const char *buf, size_t len, size_t &consumed);
 
   // internal utilities
   int fromHex(char a);
+  EncodeStatus framingError();
   TinyGPSPlus::EncodeStatus endOfTermHandler();
+  uint8_t termDecoder() const;
+  void decodeTerm(uint8_t decoder, const char *term);
+  uint16_t commitFields(uint16_t fields, bool sentenceHasDate);
+  uint16_t commitRmc();
+  uint16_t commitGga();
+  uint16_t commitGsv();
+  uint16_t commitVtg();
+  uint16_t commitGsa();
+  uint16_t commitGll();
+  uint16_t commitZda();
+  uint16_t commitGst();
+  uint16_t commitGns();
+  uint16_t commitTxt();
 };
 
+template <uint8_t Decimals>
+void TinyGPSFixed<Decimals>::set(const char *term)
+{
+   newval = TinyGPSPlus::parseFixed(term, Decimals);
+}
+
+template <uint8_t Decimals>
+int32_t TinyGPSFixed<Decimals>::in(uint8_t targetDecimals) const
+{
+   return TinyGPSPlus::rescale(val, Decimals, targetDecimals);
+}
+
 #endif // def(__TinyGPSPlus_h)
@@ -0,0 +1,240 @@
+/*
+TinyGPSAsync - C++20 coroutine interface: co_await sentences, fixes and
+satellite views of a receiver fed by the caller's event loop.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSAsync_h
+#define __TinyGPSAsync_h
+
+#include "TinyGPS++.h"
+
+// The rest of the library is C++11; this header is empty below C++20
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#include <new>
+
+// Recycles coroutine frames by size, per thread, so a steady state of
+// awaiting tasks allocates nothing
+class TinyGPSFramePool
+{
+public:
+   static TinyGPSFramePool &local()
+   {
+      thread_local TinyGPSFramePool pool;
+      return pool;
+   }
+   void *allocate(size_t size)
+   {
+      for (List &list : lists)
+         if (list.size == size && list.head)
+         {
+            Block *block = list.head;
+            list.head = block->next;
+            return block;
+         }
+      ++fresh;
+      return ::operator new(size);
+   }
+   void release(void *p, size_t size)
+   {
+      for (List &list : lists)
+         if (list.size == size || list.size == 0)
+         {
+            list.size = size;
+            list.head = new (p) Block{list.head};
+            return;
+         }
+      ::operator delete(p);
+   }
+   size_t allocations() const { return fresh; } // frames taken from the heap
+   ~TinyGPSFramePool()
+   {
+      for (List &list : lists)
+         while (list.head)
+         {
+            Block *block = list.head;
+            list.head = block->next;
+            ::operator delete(block);
+         }
+   }
+
+private:
+   struct Block { Block *next; };
+   struct List { size_t size; Block *head; };
+   List lists[8] = {};
+   size_t fresh = 0;
+};
+
+// Fire-and-forget coroutine, started right away. Its frame comes from
+// TinyGPSFramePool and is freed when the coroutine returns, or by
+// ~TinyGPSAsync() while it is waiting.
+struct TinyGPSTask
+{
+   struct promise_type
+   {
+      TinyGPSTask get_return_object() { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { std::terminate(); }
+      static void *operator new(size_t size) { return TinyGPSFramePool::local().allocate(size); }
+      static void operator delete(void *p, size_t size) { TinyGPSFramePool::local().release(p, size); }
+   };
+};
+
+// Drives one receiver from an event loop: call feed() with the bytes
+// read from the device, or poll() to read its TinyGPSStream. Waiting
+// coroutines are resumed from inside those calls, on the caller's
+// thread, right after the sentence that satisfies them.
+class TinyGPSAsync : private TinyGPSListener
+{
+public:
+   typedef TinyGPSPlus::EncodeStatus EncodeStatus;
+
+   explicit TinyGPSAsync(TinyGPSPlus &_gps) : gps(_gps), waiting(nullptr), committed(0)
+   {
+      gps.addListener(this);
+   }
+   ~TinyGPSAsync()
+   {
+      while (waiting)
+         waiting->handle.destroy(); // unlinks itself
+      gps.removeListener(this);
+   }
+   TinyGPSAsync(const TinyGPSAsync &) = delete;
+   TinyGPSAsync &operator=(const TinyGPSAsync &) = delete;
+
+   void feed(const char *buf, size_t len)
+   {
+      while (len)
+      {
+         size_t consumed = 0;
+         const EncodeStatus status = gps.encodeGiveStatus(buf, len, consumed);
+         buf += consumed;
+         len -= consumed;
+         if (status != EncodeStatus::UNFINISHED)
+            wake(status);
+      }
+   }
+   void poll()
+   {
+      EncodeStatus status;
+      while ((status = gps.readSerialGiveStatus()) != EncodeStatus::UNFINISHED)
+         wake(status);
+   }
+
+   // Base of the awaitables; lives in the awaiting coroutine's frame
+   class Wait
+   {
+   public:
+      bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> h)
+      {
+         handle = h;
+         next = async.waiting;
+         async.waiting = this;
+         queued = true;
+      }
+      ~Wait()
+      {
+         if (queued)
+            for (Wait **link = &async.waiting; *link; link = &(*link)->next)
+               if (*link == this)
+               {
+                  *link = next;
+                  break;
+               }
+      }
+      Wait(const Wait &) = delete;
+
+   protected:
+      Wait(TinyGPSAsync &_async, EncodeStatus _status, uint16_t _fields)
+         : async(_async), status(_status), fields(_fields), woke(EncodeStatus::UNFINISHED), queued(false), next(nullptr)
+      {}
+      TinyGPSAsync &async;
+      const EncodeStatus status; // UNFINISHED: any sentence
+      const uint16_t fields;     // 0: any fields
+      EncodeStatus woke;
+
+   private:
+      friend class TinyGPSAsync;
+      bool queued;
+      std::coroutine_handle<> handle;
+      Wait *next;
+   };
+
+   class SentenceWait : public Wait
+   {
+   public:
+      SentenceWait(TinyGPSAsync &async, EncodeStatus status) : Wait(async, status, 0) {}
+      EncodeStatus await_resume() const { return woke; }
+   };
+   class FixWait : public Wait
+   {
+   public:
+      explicit FixWait(TinyGPSAsync &async) : Wait(async, EncodeStatus::UNFINISHED, 1u << TinyGPSSnapshot::LOCATION) {}
+      TinyGPSPlus &await_resume() const { return async.gps; }
+   };
+   class SatelliteViewWait : public Wait
+   {
+   public:
+      explicit SatelliteViewWait(TinyGPSAsync &async) : Wait(async, EncodeStatus::UNFINISHED, 1u << TinyGPSSnapshot::SATS_IN_VIEW) {}
+      const SatsInView &await_resume() const { return async.gps.satsInView; }
+   };
+
+   // The sentence of the given type passed its checksum; INVALID waits
+   // for a corrupted one
+   SentenceWait nextSentence(EncodeStatus status) { return SentenceWait(*this, status); }
+   // An RMC, GGA or GNS with a fix; gives the receiver to read it from
+   FixWait nextFix() { return FixWait(*this); }
+   // A complete GSV group
+   SatelliteViewWait nextSatelliteView() { return SatelliteViewWait(*this); }
+
+   const TinyGPSPlus &receiver() const { return gps; }
+
+private:
+   TinyGPSPlus &gps;
+   Wait *waiting; // most recent first
+   uint16_t committed; // fields of the sentence being reported
+
+   void onCommit(const TinyGPSPlus &, uint16_t fields) override { committed |= fields; }
+
+   void wake(EncodeStatus status)
+   {
+      const uint16_t fields = committed;
+      committed = 0;
+      // Unlink the satisfied waits first: resumed coroutines queue new ones
+      Wait *ready = nullptr;
+      for (Wait **link = &waiting; *link;)
+      {
+         Wait *w = *link;
+         const bool match = w->fields ? (w->fields & fields) != 0 :
+            w->status == EncodeStatus::UNFINISHED ? status != EncodeStatus::INVALID : w->status == status;
+         if (match)
+         {
+            *link = w->next;
+            w->queued = false;
+            w->next = ready; // restores the order of co_await
+            ready = w;
+         }
+         else
+            link = &w->next;
+      }
+      while (ready)
+      {
+         Wait *w = ready;
+         ready = w->next;
+         w->woke = status;
+         w->handle.resume();
+      }
+   }
+};
+
+#endif // C++20
+#endif // def(__TinyGPSAsync_h)
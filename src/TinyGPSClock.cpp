@@ -0,0 +1,105 @@
+/*
+TinyGPSClock - disciplines a local microsecond clock to NMEA UTC using
+sentence arrival times, for hosts without a PPS line.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSClock.h"
+
+#define _GPS_CLOCK_STEP_US 1000000LL // larger errors restart the filter
+
+TinyGPSClock::TinyGPSClock()
+  :  latencyUs(0)
+{
+   reset();
+}
+
+void TinyGPSClock::reset()
+{
+   samples = 0;
+   lastLocal = 0;
+   localBase = 0;
+   windowCount = 0;
+   hasRef = hasNextRef = false;
+   rateQ24 = 0;
+}
+
+void TinyGPSClock::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   const TinyGPSTimestamp &ts = gps.timestamp;
+   if ((fields & (1u << TinyGPSSnapshot::TIME)) && ts.valid)
+      add((uint64_t)ts.seconds * 1000000 + ts.centis * 10000UL, ts.arrivalTime * 1000UL);
+}
+
+int64_t TinyGPSClock::predict(uint64_t utc) const
+{
+   return anchor.offset + (((int64_t)(utc - anchor.utc) * rateQ24) >> 24);
+}
+
+uint64_t TinyGPSClock::utcUs(uint32_t localUs) const
+{
+   const uint64_t local = localBase + (uint32_t)(localUs - lastLocal);
+   const uint64_t guess = local - anchor.offset;
+   return local - predict(guess);
+}
+
+int32_t TinyGPSClock::driftPpb() const
+{
+   return (int32_t)(((int64_t)rateQ24 * 1000000000LL) >> 24);
+}
+
+void TinyGPSClock::add(uint64_t utc, uint32_t localUs)
+{
+   localBase += (uint32_t)(localUs - lastLocal);
+   lastLocal = localUs;
+   const Point p = {utc, (int64_t)(localBase - utc) - (int64_t)latencyUs};
+
+   const int64_t err = samples ? p.offset - predict(p.utc) : 0;
+   if (samples == 0 || err > _GPS_CLOCK_STEP_US || err < -_GPS_CLOCK_STEP_US)
+   {
+      // First sample, time jump or lost lock: restart, keep the drift
+      anchor = windowMin = p;
+      windowCount = 1;
+      hasRef = hasNextRef = false;
+      samples = 1;
+      return;
+   }
+   samples++;
+
+   // Less latency than the envelope predicts: this is the better anchor
+   if (err < 0)
+      anchor = p;
+   if (windowCount == 0 || p.offset < windowMin.offset + (((int64_t)(p.utc - windowMin.utc) * rateQ24) >> 24))
+      windowMin = p;
+   if (++windowCount < _GPS_CLOCK_WINDOW)
+      return;
+
+   // Window complete: its minimum updates drift and anchors the offset
+   if (hasRef && windowMin.utc > ref.utc)
+   {
+      const int64_t span = (int64_t)(windowMin.utc - ref.utc);
+      // Multiplied, not shifted: the difference is negative when the local clock runs slow
+      rateQ24 = (int32_t)((windowMin.offset - ref.offset) * ((int64_t)1 << 24) / span);
+      if (!hasNextRef && span >= _GPS_CLOCK_BASELINE_US / 2)
+      {
+         nextRef = windowMin;
+         hasNextRef = true;
+      }
+      if (span >= _GPS_CLOCK_BASELINE_US && hasNextRef)
+      {
+         ref = nextRef;
+         hasNextRef = false;
+      }
+   }
+   else if (!hasRef)
+   {
+      ref = windowMin;
+      hasRef = true;
+   }
+   anchor = windowMin;
+   windowCount = 0;
+}
@@ -0,0 +1,64 @@
+/*
+TinyGPSClock - disciplines a local microsecond clock to NMEA UTC using
+sentence arrival times, for hosts without a PPS line.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSClock_h
+#define __TinyGPSClock_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_CLOCK_WINDOW 16               // samples per minimum-latency window
+#define _GPS_CLOCK_BASELINE_US 1024000000LL // drift baseline before it slides
+
+// Each sample gives offset = local arrival - UTC - latency. Serial
+// transmission only ever delays a sentence, so the true clock offset is
+// the lower envelope of these samples. The minimum of every window of
+// _GPS_CLOCK_WINDOW samples anchors the offset; drift is the slope
+// between window minima over a long, sliding baseline. A sample below
+// the predicted envelope is taken as the new anchor immediately.
+// The constant part of the latency is given by setLatency().
+class TinyGPSClock : public TinyGPSListener
+{
+public:
+   TinyGPSClock();
+   // Uses TinyGPSTimestamp::arrival(), i.e. millis() resolution
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+   // utcUs: UTC of the sentence in Unix microseconds; localUs: arrival of its '$'
+   void add(uint64_t utcUs, uint32_t localUs);
+   void reset();
+   void setLatency(uint32_t us) { latencyUs = us; }
+
+   bool isValid() const { return samples > 1; }
+   // O(1); localUs must not be older than the last sample and the local
+   // clock must not wrap (~71 min) between samples
+   uint64_t utcUs(uint32_t localUs) const;
+   // Local clock rate error in parts per billion (positive: local runs fast)
+   int32_t driftPpb() const;
+
+private:
+   struct Point
+   {
+      uint64_t utc;
+      int64_t offset;
+   };
+   int64_t predict(uint64_t utc) const;
+
+   uint32_t samples;
+   uint32_t latencyUs;
+   uint32_t lastLocal;
+   uint64_t localBase; // lastLocal extended to 64 bits
+   Point anchor;
+   Point windowMin;
+   uint8_t windowCount;
+   Point ref, nextRef;
+   bool hasRef, hasNextRef;
+   int32_t rateQ24; // offset change per UTC microsecond
+};
+
+#endif // def(__TinyGPSClock_h)
@@ -0,0 +1,280 @@
+/*
+TinyGPSColumns - fixed-width columnar export of fixes and aggregate
+kernels over the columns, for host-side analytics.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+// Exports from a host process; std::thread and stdio files have no
+// counterpart on the boards
+#if defined(__linux__)
+#include "TinyGPSColumns.h"
+#include "TinyGPSTrack.h"
+
+#include <string.h>
+#include <thread>
+
+#define FIELD(field) (1u << TinyGPSSnapshot::field)
+
+namespace
+{
+const char blockMagic[4] = {'T', 'G', 'C', '1'};
+
+template <class T>
+bool writeColumn(FILE *file, const std::vector<T> &column)
+{
+   return fwrite(column.data(), sizeof(T), column.size(), file) == column.size();
+}
+
+template <class T>
+bool readColumn(FILE *file, std::vector<T> &column, size_t rows)
+{
+   const size_t start = column.size();
+   column.resize(start + rows);
+   return fread(column.data() + start, sizeof(T), rows, file) == rows;
+}
+
+uint16_t clamp16(int32_t value)
+{
+   return value < 0 ? 0 : value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+}
+
+void TinyGPSColumns::clear()
+{
+   time.clear();
+   lat.clear();
+   lng.clear();
+   speed.clear();
+   course.clear();
+   altitude.clear();
+   hdop.clear();
+   pdop.clear();
+   sats.clear();
+   fix.clear();
+}
+
+void TinyGPSColumns::reserve(size_t rows)
+{
+   time.reserve(rows);
+   lat.reserve(rows);
+   lng.reserve(rows);
+   speed.reserve(rows);
+   course.reserve(rows);
+   altitude.reserve(rows);
+   hdop.reserve(rows);
+   pdop.reserve(rows);
+   sats.reserve(rows);
+   fix.reserve(rows);
+}
+
+void TinyGPSColumns::addRow(int64_t timeMs)
+{
+   time.push_back(timeMs);
+   lat.push_back(0);
+   lng.push_back(0);
+   speed.push_back(0);
+   course.push_back(0);
+   altitude.push_back(0);
+   hdop.push_back(0);
+   pdop.push_back(0);
+   sats.push_back(0);
+   fix.push_back(FIX_NONE);
+}
+
+bool TinyGPSColumns::write(FILE *file) const
+{
+   const uint32_t rows = (uint32_t)size();
+   return fwrite(blockMagic, 1, sizeof(blockMagic), file) == sizeof(blockMagic) &&
+      fwrite(&rows, sizeof(rows), 1, file) == 1 &&
+      writeColumn(file, time) && writeColumn(file, lat) && writeColumn(file, lng) &&
+      writeColumn(file, speed) && writeColumn(file, course) && writeColumn(file, altitude) &&
+      writeColumn(file, hdop) && writeColumn(file, pdop) && writeColumn(file, sats) &&
+      writeColumn(file, fix);
+}
+
+bool TinyGPSColumns::read(FILE *file)
+{
+   char magic[sizeof(blockMagic)];
+   uint32_t rows;
+   if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, blockMagic, sizeof(magic)) != 0 ||
+      fread(&rows, sizeof(rows), 1, file) != 1)
+      return false;
+   return readColumn(file, time, rows) && readColumn(file, lat, rows) && readColumn(file, lng, rows) &&
+      readColumn(file, speed, rows) && readColumn(file, course, rows) && readColumn(file, altitude, rows) &&
+      readColumn(file, hdop, rows) && readColumn(file, pdop, rows) && readColumn(file, sats, rows) &&
+      readColumn(file, fix, rows);
+}
+
+TinyGPSColumnExport::TinyGPSColumnExport(TinyGPSColumns &_columns, FILE *_file, size_t _blockRows)
+  :  columns(_columns)
+  ,  file(_file)
+  ,  blockRows(_blockRows)
+{
+}
+
+void TinyGPSColumnExport::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   if (fields & FIELD(GSA))
+   {
+      if (columns.size() != 0)
+      {
+         const size_t row = columns.size() - 1;
+         columns.pdop[row] = clamp16(TinyGPSPlus::rescale(gps.gsa.rawPdop(), Gsa::Fixed::decimals, 2));
+         const char *dimension = gps.gsa.fix();
+         if (columns.fix[row] != TinyGPSColumns::FIX_NONE && dimension)
+         {
+            if (strcmp(dimension, "3D") == 0)
+               columns.fix[row] = TinyGPSColumns::FIX_3D;
+            else if (strcmp(dimension, "2D") == 0)
+               columns.fix[row] = TinyGPSColumns::FIX_2D;
+         }
+      }
+      return;
+   }
+   if (!(fields & FIELD(TIME)))
+      return;
+
+   int64_t timeMs;
+   if (gps.timestamp.valid)
+      timeMs = (int64_t)gps.timestamp.seconds * 1000 + gps.timestamp.centis * 10;
+   else
+   {
+      // No date yet (GGA-only output): time of day
+      const uint32_t t = gps.time.peek();
+      timeMs = ((t / 1000000) * 3600 + (t / 10000 % 100) * 60 + t / 100 % 100) * 1000 + t % 100 * 10;
+   }
+   if (columns.size() == 0 || columns.time.back() != timeMs)
+   {
+      if (file && columns.size() >= blockRows)
+         flush();
+      columns.addRow(timeMs);
+   }
+   const size_t row = columns.size() - 1;
+
+   if (fields & FIELD(LOCATION))
+   {
+      columns.lat[row] = TinyGPSTrack::toE7(gps.location.rawLatData);
+      columns.lng[row] = TinyGPSTrack::toE7(gps.location.rawLngData);
+      if (columns.fix[row] == TinyGPSColumns::FIX_NONE)
+         columns.fix[row] = TinyGPSColumns::FIX_UNKNOWN;
+   }
+   if (fields & FIELD(SPEED))
+      columns.speed[row] = clamp16(gps.speed.in(2));
+   if (fields & FIELD(COURSE))
+      columns.course[row] = clamp16(gps.course.in(2));
+   if (fields & FIELD(ALTITUDE))
+      columns.altitude[row] = gps.altitude.in(2);
+   if (fields & FIELD(HDOP))
+      columns.hdop[row] = clamp16(gps.hdop.in(2));
+   if (fields & FIELD(SATELLITES))
+      columns.sats[row] = gps.satellites.val > 0xFF ? 0xFF : (uint8_t)gps.satellites.val;
+}
+
+bool TinyGPSColumnExport::flush()
+{
+   if (!file || columns.size() == 0)
+      return true;
+   const bool ok = columns.write(file);
+   columns.clear();
+   return ok;
+}
+
+size_t TinyGPSAggregate::countAtLeast(const uint8_t *values, size_t n, uint8_t minimum)
+{
+   size_t count = 0;
+   for (size_t i = 0; i < n; ++i)
+      count += values[i] >= minimum;
+   return count;
+}
+
+uint64_t TinyGPSAggregate::sum(const uint16_t *values, size_t n)
+{
+   uint64_t total = 0;
+   for (size_t i = 0; i < n; ++i)
+      total += values[i];
+   return total;
+}
+
+void TinyGPSAggregate::histogram(const uint16_t *values, size_t n, uint16_t binWidth, uint32_t *bins, size_t binCount)
+{
+   if (binCount == 0 || binWidth == 0)
+      return;
+   for (size_t i = 0; i < n; ++i)
+   {
+      size_t bin = values[i] / binWidth;
+      bins[bin < binCount ? bin : binCount - 1]++;
+   }
+}
+
+void TinyGPSAggregate::histogram(const uint8_t *values, size_t n, uint32_t *bins, size_t binCount)
+{
+   if (binCount == 0)
+      return;
+   // Four sub-histograms so that runs of equal values, which are the
+   // norm for satellite counts, do not serialise on one counter
+   uint32_t partial[4][256] = {};
+   size_t i = 0;
+   for (; i + 4 <= n; i += 4)
+   {
+      partial[0][values[i]]++;
+      partial[1][values[i + 1]]++;
+      partial[2][values[i + 2]]++;
+      partial[3][values[i + 3]]++;
+   }
+   for (; i < n; ++i)
+      partial[0][values[i]]++;
+   for (size_t v = 0; v < 256; ++v)
+   {
+      const uint32_t total = partial[0][v] + partial[1][v] + partial[2][v] + partial[3][v];
+      bins[v < binCount ? v : binCount - 1] += total;
+   }
+}
+
+void TinyGPSAggregate::parallelHistogram(const uint16_t *values, size_t n, uint16_t binWidth, uint32_t *bins, size_t binCount, unsigned threads)
+{
+   if (threads < 2 || n < threads)
+   {
+      histogram(values, n, binWidth, bins, binCount);
+      return;
+   }
+   std::vector<std::vector<uint32_t> > partial(threads, std::vector<uint32_t>(binCount));
+   std::vector<std::thread> workers;
+   // Even splits; rounding the chunk up could leave the last threads past n
+   for (unsigned t = 0; t < threads; ++t)
+   {
+      const size_t begin = t * n / threads;
+      const size_t end = (t + 1) * n / threads;
+      workers.emplace_back([=, &partial]() {
+         histogram(values + begin, end - begin, binWidth, partial[t].data(), binCount);
+      });
+   }
+   for (std::thread &worker : workers)
+      worker.join();
+   for (const std::vector<uint32_t> &p : partial)
+      for (size_t b = 0; b < binCount; ++b)
+         bins[b] += p[b];
+}
+
+uint32_t TinyGPSAggregate::percentile(const uint32_t *bins, size_t binCount, uint16_t binWidth, uint8_t percent)
+{
+   uint64_t total = 0;
+   for (size_t b = 0; b < binCount; ++b)
+      total += bins[b];
+   if (total == 0)
+      return 0;
+   const uint64_t rank = (total * percent + 99) / 100;
+   uint64_t seen = 0;
+   for (size_t b = 0; b < binCount; ++b)
+   {
+      seen += bins[b];
+      if (seen >= rank && seen != 0)
+         return (uint32_t)(b + 1) * binWidth;
+   }
+   return (uint32_t)binCount * binWidth;
+}
+
+#endif // defined(__linux__)
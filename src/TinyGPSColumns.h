@@ -0,0 +1,85 @@
+/*
+TinyGPSColumns - fixed-width columnar export of fixes and aggregate
+kernels over the columns, for host-side analytics.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSColumns_h
+#define __TinyGPSColumns_h
+
+#include "TinyGPS++.h"
+#include <stdio.h>
+#include <vector>
+
+// One row per epoch. Units are fixed regardless of the _GPS_*_DECIMALS
+// configuration of the parser.
+struct TinyGPSColumns
+{
+   enum Fix : uint8_t
+   {
+      FIX_NONE = 0,
+      FIX_UNKNOWN = 1, // position without a GSA for the epoch
+      FIX_2D = 2,
+      FIX_3D = 3
+   };
+
+   std::vector<int64_t> time;      // Unix milliseconds; of the UTC day before a date is known
+   std::vector<int32_t> lat, lng;  // 1e-7 degrees
+   std::vector<uint16_t> speed;    // 0.01 knots
+   std::vector<uint16_t> course;   // 0.01 degrees
+   std::vector<int32_t> altitude;  // 0.01 m
+   std::vector<uint16_t> hdop;     // 0.01
+   std::vector<uint16_t> pdop;     // 0.01
+   std::vector<uint8_t> sats;
+   std::vector<uint8_t> fix;       // Fix
+
+   size_t size() const { return time.size(); }
+   void clear();
+   void reserve(size_t rows);
+   void addRow(int64_t timeMs); // zeroed row
+
+   // Block file format: "TGC1", uint32 row count, then each column in
+   // the order above as a contiguous native-endian array
+   bool write(FILE *file) const;
+   bool read(FILE *file); // appends one block; false at end of file or on error
+};
+
+// Builds rows from commits. Sentences of the same epoch (same UTC
+// time) fill one row; GSA adds PDOP and the fix dimension to the row
+// before it. With a file, every blockRows rows are written as a block.
+class TinyGPSColumnExport : public TinyGPSListener
+{
+public:
+   explicit TinyGPSColumnExport(TinyGPSColumns &columns, FILE *file = nullptr, size_t blockRows = 65536);
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+   bool flush(); // writes the rows held so far if there is a file
+
+private:
+   TinyGPSColumns &columns;
+   FILE *file;
+   size_t blockRows;
+};
+
+// Kernels over column ranges. Each one is a straight loop over one
+// array, so compilers vectorise the counting ones, and results of
+// disjoint ranges merge by addition; the parallel variants split the
+// range over threads that way.
+struct TinyGPSAggregate
+{
+   // Rows with fix >= minFix; availability = result / n
+   static size_t countAtLeast(const uint8_t *values, size_t n, uint8_t minimum);
+   static uint64_t sum(const uint16_t *values, size_t n);
+   // bins[i] += values in [i * binWidth, (i + 1) * binWidth); the last
+   // bin also takes everything above
+   static void histogram(const uint16_t *values, size_t n, uint16_t binWidth, uint32_t *bins, size_t binCount);
+   static void histogram(const uint8_t *values, size_t n, uint32_t *bins, size_t binCount);
+   static void parallelHistogram(const uint16_t *values, size_t n, uint16_t binWidth, uint32_t *bins, size_t binCount, unsigned threads);
+   // Upper edge of the bin holding the given percentile
+   static uint32_t percentile(const uint32_t *bins, size_t binCount, uint16_t binWidth, uint8_t percent);
+};
+
+#endif // def(__TinyGPSColumns_h)
@@ -0,0 +1,152 @@
+/*
+TinyGPSCommands - non-blocking configuration queue for u-blox receivers
+with UBX-ACK tracking, timeouts and retries.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSCommands.h"
+#include "TinyGPSPlanner.h"
+
+#include <string.h>
+
+TinyGPSCommands::TinyGPSCommands(TinyGPSPlus &_gps, uint32_t baud)
+  :  gps(_gps)
+  ,  head(0)
+  ,  count(0)
+  ,  nextTicket(1)
+  ,  linkBaud(baud ? baud : 9600)
+  ,  sentAt(0)
+  ,  waitMs(0)
+{
+   memset(slots, 0, sizeof(slots));
+   gps.addListener(this);
+}
+
+TinyGPSCommands::~TinyGPSCommands()
+{
+   gps.removeListener(this);
+}
+
+uint16_t TinyGPSCommands::ubx(const uint8_t *frame, size_t length, Callback cb, void *context)
+{
+   if (length < 8 || frame[0] != 0xB5 || frame[1] != 0x62)
+      return 0;
+   return push(UBX, frame, length, 0, cb, context);
+}
+
+uint16_t TinyGPSCommands::pubx(const char *sentence, Callback cb, void *context)
+{
+   return push(PUBX, (const uint8_t *)sentence, strlen(sentence), 0, cb, context);
+}
+
+uint16_t TinyGPSCommands::baudrate(uint32_t baud, Callback cb, void *context)
+{
+   if (baud == 0)
+      return 0;
+   return push(BAUD, 0, 0, baud, cb, context);
+}
+
+uint16_t TinyGPSCommands::push(Kind kind, const uint8_t *data, size_t length, uint32_t baud, Callback cb, void *context)
+{
+   if (count == _GPS_CMD_QUEUE_SIZE)
+      return 0;
+   Command &cmd = slots[(head + count) % _GPS_CMD_QUEUE_SIZE];
+   cmd.ticket = nextTicket;
+   cmd.kind = kind;
+   cmd.status = Status::QUEUED;
+   cmd.attempts = 0;
+   cmd.data = data;
+   cmd.length = length;
+   cmd.baud = baud;
+   cmd.cb = cb;
+   cmd.context = context;
+   ++count;
+   if (++nextTicket == 0)
+      nextTicket = 1;
+   return cmd.ticket;
+}
+
+TinyGPSCommands::Status TinyGPSCommands::status(uint16_t ticket) const
+{
+   for (const Command &cmd : slots)
+      if (ticket != 0 && cmd.ticket == ticket)
+         return cmd.status;
+   return Status::UNKNOWN;
+}
+
+void TinyGPSCommands::poll()
+{
+   if (count == 0)
+      return;
+   Command &cmd = slots[head];
+   if (cmd.status == Status::SENT && millis() - sentAt >= waitMs)
+   {
+      switch (cmd.kind)
+      {
+      case UBX:
+         if (cmd.attempts <= _GPS_CMD_RETRIES)
+            send(cmd);
+         else
+            finish(cmd, false);
+         break;
+      case PUBX:
+         finish(cmd, true);
+         break;
+      case BAUD:
+         gps.setStreamBaudrate(cmd.baud);
+         linkBaud = cmd.baud;
+         finish(cmd, true);
+         break;
+      }
+   }
+   if (count != 0 && slots[head].status == Status::QUEUED)
+      send(slots[head]);
+}
+
+void TinyGPSCommands::onUbxAck(uint8_t msgClass, uint8_t msgId, bool ack)
+{
+   if (count == 0)
+      return;
+   Command &cmd = slots[head];
+   if (cmd.kind == UBX && cmd.status == Status::SENT && cmd.data[2] == msgClass && cmd.data[3] == msgId)
+      finish(cmd, ack);
+}
+
+void TinyGPSCommands::send(Command &cmd)
+{
+   size_t length = cmd.length;
+   if (cmd.kind == BAUD)
+   {
+      length = TinyGPSPlanner::pubx41(cmd.baud, pubx41, sizeof(pubx41));
+      gps.sendByteSentence((const uint8_t *)pubx41, length);
+   }
+   else
+   {
+      gps.sendByteSentence(cmd.data, length);
+   }
+   ++cmd.attempts;
+   cmd.status = Status::SENT;
+   sentAt = millis();
+   waitMs = drainMs(length + 2);
+   if (cmd.kind == UBX)
+      waitMs += _GPS_CMD_TIMEOUT_MS;
+}
+
+void TinyGPSCommands::finish(Command &cmd, bool ok)
+{
+   cmd.status = ok ? Status::DONE : Status::FAILED;
+   head = (head + 1) % _GPS_CMD_QUEUE_SIZE;
+   --count;
+   if (cmd.cb)
+      cmd.cb(cmd.ticket, ok, cmd.context);
+}
+
+// Time for the UART to shift out 'bytes' at 8N1
+uint32_t TinyGPSCommands::drainMs(size_t bytes) const
+{
+   return ((uint32_t)bytes * 10000 + linkBaud - 1) / linkBaud;
+}
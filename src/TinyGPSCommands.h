@@ -0,0 +1,87 @@
+/*
+TinyGPSCommands - non-blocking configuration queue for u-blox receivers
+with UBX-ACK tracking, timeouts and retries.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSCommands_h
+#define __TinyGPSCommands_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_CMD_QUEUE_SIZE 8
+#define _GPS_CMD_TIMEOUT_MS 250 // per UBX attempt, after the frame is sent
+#define _GPS_CMD_RETRIES 3
+
+// Commands run one at a time, in order, from poll(), which must be called
+// from the main loop next to readSerial(). UBX CFG frames complete on
+// UBX-ACK-ACK and fail on ACK-NAK or after the last retry times out.
+// $PUBX sentences are not acknowledged by the receiver; they complete
+// once they have left the UART. A baud rate change waits for its
+// $PUBX,41 to leave the UART before switching the local side.
+// Command bytes are not copied and must stay valid until completion.
+class TinyGPSCommands : public TinyGPSListener
+{
+public:
+   enum class Status : uint8_t
+   {
+      UNKNOWN,  // no such ticket, or its slot has been reused
+      QUEUED,
+      SENT,
+      DONE,
+      FAILED
+   };
+   // Called once per command; ok is false on NAK or timeout
+   typedef void (*Callback)(uint16_t ticket, bool ok, void *context);
+
+   // baud: the rate the link runs at now; 0 is taken as the receivers'
+   // default of 9600
+   TinyGPSCommands(TinyGPSPlus &gps, uint32_t baud);
+   ~TinyGPSCommands();
+
+   // Return a ticket, or 0 if the queue is full (or baud is 0)
+   uint16_t ubx(const uint8_t *frame, size_t length, Callback cb = 0, void *context = 0);
+   uint16_t pubx(const char *sentence, Callback cb = 0, void *context = 0); // without CRLF
+   uint16_t baudrate(uint32_t baud, Callback cb = 0, void *context = 0);
+
+   void poll();
+   Status status(uint16_t ticket) const;
+   bool idle() const { return count == 0; }
+   uint32_t baud() const { return linkBaud; }
+
+   void onCommit(const TinyGPSPlus &, uint16_t) override {}
+   void onUbxAck(uint8_t msgClass, uint8_t msgId, bool ack) override;
+
+private:
+   enum Kind : uint8_t { UBX, PUBX, BAUD };
+   struct Command
+   {
+      uint16_t ticket;
+      Kind kind;
+      Status status;
+      uint8_t attempts;
+      const uint8_t *data;
+      size_t length;
+      uint32_t baud;
+      Callback cb;
+      void *context;
+   };
+   uint16_t push(Kind kind, const uint8_t *data, size_t length, uint32_t baud, Callback cb, void *context);
+   void send(Command &cmd);
+   void finish(Command &cmd, bool ok);
+   uint32_t drainMs(size_t bytes) const;
+
+   TinyGPSPlus &gps;
+   Command slots[_GPS_CMD_QUEUE_SIZE];
+   uint8_t head, count;
+   uint16_t nextTicket;
+   uint32_t linkBaud;
+   uint32_t sentAt, waitMs;
+   char pubx41[40];
+};
+
+#endif // def(__TinyGPSCommands_h)
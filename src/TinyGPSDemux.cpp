@@ -0,0 +1,341 @@
+/*
+TinyGPSDemux - splits a port carrying NMEA, UBX and RTCM3 into verified
+frames, so binary frames never reach the sentence parser.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSDemux.h"
+#include <string.h>
+
+// CRC-24Q (polynomial 0x1864CFB) of each nibble. Four bit-steps per
+// lookup; 64 bytes where a byte-wide table would take 1 KB of AVR RAM.
+const uint32_t TinyGPSDemux::crc24qNibbles[16] = {
+   0x000000, 0x864CFB, 0x8AD50D, 0x0C99F6, 0x93E6E1, 0x15AA1A, 0x1933EC, 0x9F7F17,
+   0xA18139, 0x27CDC2, 0x2B5434, 0xAD18CF, 0x3267D8, 0xB42B23, 0xB8B2D5, 0x3EFE2E
+};
+
+TinyGPSDemux::TinyGPSDemux(TinyGPSPlus *_gps, FrameHandler _handler, void *_context)
+  :  oversized(0)
+  ,  skipped(0)
+  ,  gps(_gps)
+  ,  handler(_handler)
+  ,  context(_context)
+  ,  state(IDLE)
+  ,  protocol(TinyGPSFrame::NMEA)
+  ,  start(0)
+  ,  have(0)
+  ,  frameLength(0)
+  ,  digits(0)
+  ,  check(0)
+  ,  expected(0)
+{
+}
+
+uint8_t TinyGPSDemux::xorChecksum(const uint8_t *p, size_t n, uint8_t parity)
+{
+   while (n--)
+      parity ^= *p++;
+   return parity;
+}
+
+uint16_t TinyGPSDemux::fletcher8(const uint8_t *p, size_t n, uint16_t ck)
+{
+   uint8_t a = ck, b = ck >> 8;
+   while (n--)
+   {
+      a += *p++;
+      b += a;
+   }
+   return a | b << 8;
+}
+
+uint32_t TinyGPSDemux::crc24q(const uint8_t *p, size_t n, uint32_t crc)
+{
+   while (n--)
+   {
+      crc = (crc << 4 & 0xFFFFFF) ^ crc24qNibbles[(crc >> 20 ^ *p >> 4) & 0xF];
+      crc = (crc << 4 & 0xFFFFFF) ^ crc24qNibbles[(crc >> 20 ^ *p++) & 0xF];
+   }
+   return crc;
+}
+
+void TinyGPSDemux::feed(const uint8_t *buf, size_t len)
+{
+   while (len)
+   {
+      size_t consumed = 0;
+      feed(buf, len, consumed);
+      buf += consumed;
+      len -= consumed;
+   }
+}
+
+TinyGPSDemux::EncodeStatus TinyGPSDemux::feed(const uint8_t *buf, size_t len, size_t &consumed)
+{
+   EncodeStatus status = EncodeStatus::UNFINISHED;
+   size_t i = 0;
+   while (i < len && status == EncodeStatus::UNFINISHED)
+   {
+      const uint8_t b = buf[i];
+      switch (state)
+      {
+      case IDLE:
+      {
+         const size_t from = i;
+         while (i < len && buf[i] != '$' && buf[i] != 0xB5 && buf[i] != 0xD3)
+            ++i;
+         skipped += i - from;
+         if (i < len)
+            begin(buf + i);
+         break;
+      }
+
+      case NMEA_PARSER:
+      {
+         const uint32_t passed = gps->passedChecksum();
+         size_t used = 0;
+         status = gps->encodeSentence((const char *)buf + i, len - i, used);
+         i += used;
+         if (!gps->inSentence)
+         {
+            state = IDLE;
+            frames.nmea += gps->passedChecksum() - passed;
+            // A binary sync that cut the sentence short starts the next frame
+            if (buf[i - 1] == 0xB5 || buf[i - 1] == 0xD3)
+               --i;
+         }
+         break;
+      }
+
+      case NMEA_BODY:
+         // Room for the checksum and line end
+         if (have >= _GPS_DEMUX_FRAME_SIZE - 4 || (have && (b == '$' || b < 0x20 || b > 0x7E)))
+         {
+            abort(); // b is looked at again
+            break;
+         }
+         if (b == '*')
+            state = NMEA_CHECKSUM;
+         else if (have)
+            check ^= b;
+         take(buf + i++, 1);
+         break;
+
+      case NMEA_CHECKSUM:
+      {
+         const int digit = b >= '0' && b <= '9' ? b - '0' : b >= 'A' && b <= 'F' ? b - 'A' + 10 :
+                           b >= 'a' && b <= 'f' ? b - 'a' + 10 : -1;
+         if (digit < 0)
+         {
+            abort();
+            break;
+         }
+         expected = expected << 4 | digit;
+         take(buf + i++, 1);
+         if (++digits == 2)
+            state = NMEA_END;
+         break;
+      }
+
+      case NMEA_END:
+         if (b != '\n' && (b != '\r' || bytes()[have - 1] == '\r'))
+         {
+            abort();
+            break;
+         }
+         take(buf + i++, 1);
+         if (b == '\n')
+         {
+            if (check == expected)
+               finish();
+            else
+            {
+               ++checksumErrors.nmea;
+               abort();
+            }
+         }
+         break;
+
+      case UBX_HEADER:
+         if (have == 1 && b != 0x62)
+         {
+            abort();
+            break;
+         }
+         if (have >= 2)
+            check = fletcher8(&b, 1, check);
+         take(buf + i++, 1);
+         if (have == 6)
+         {
+            const uint32_t length = 6 + (bytes()[4] | bytes()[5] << 8) + 2;
+            if (length > _GPS_DEMUX_FRAME_SIZE)
+            {
+               ++oversized;
+               i = resync(buf, i, status);
+            }
+            else
+            {
+               frameLength = length;
+               state = BINARY_BODY;
+            }
+         }
+         break;
+
+      case RTCM_HEADER:
+         // Six reserved bits, then a 10-bit length that must hold a message number
+         if (have == 1 && (b & 0xFC))
+         {
+            abort();
+            break;
+         }
+         check = crc24q(&b, 1, check);
+         take(buf + i++, 1);
+         if (have == 3)
+         {
+            const uint16_t payload = (bytes()[1] & 0x03) << 8 | bytes()[2];
+            if (payload < 2)
+               i = resync(buf, i, status);
+            else if (3 + payload + 3 > _GPS_DEMUX_FRAME_SIZE)
+            {
+               ++oversized;
+               i = resync(buf, i, status);
+            }
+            else
+            {
+               frameLength = 3 + payload + 3;
+               state = BINARY_BODY;
+            }
+         }
+         break;
+
+      case BINARY_BODY:
+      {
+         // The rest of the frame, or of this buffer, in one span
+         const uint8_t trailer = protocol == TinyGPSFrame::UBX ? 2 : 3;
+         const uint16_t covered = frameLength - trailer;
+         const uint8_t *p = buf + i;
+         size_t n = frameLength - have;
+         if (n > len - i)
+            n = len - i;
+         if (have < covered)
+         {
+            const size_t body = n < (size_t)(covered - have) ? n : covered - have;
+            check = protocol == TinyGPSFrame::UBX ? fletcher8(p, body, check) : crc24q(p, body, check);
+         }
+         for (size_t k = have < covered ? covered - have : 0; k < n; ++k)
+         {
+            if (protocol == TinyGPSFrame::UBX)
+               expected |= (uint32_t)p[k] << 8 * (have + k - covered);
+            else
+               expected = expected << 8 | p[k];
+         }
+         take(p, n);
+         i += n;
+         if (have == frameLength)
+         {
+            if (check == expected)
+               finish();
+            else
+            {
+               ++counter(checksumErrors);
+               i = resync(buf, i, status);
+            }
+         }
+         break;
+      }
+      }
+   }
+
+   // A frame in progress is kept for the next call; when resync feeds
+   // the assembly buffer back in, start may point into it
+   if (start && state != IDLE)
+   {
+      memmove(frame, start, have);
+      start = 0;
+   }
+   consumed = i;
+   return status;
+}
+
+void TinyGPSDemux::begin(const uint8_t *sync)
+{
+   start = sync;
+   have = 0;
+   frameLength = 0;
+   digits = 0;
+   check = expected = 0;
+   switch (*sync)
+   {
+   case '$':
+      protocol = TinyGPSFrame::NMEA;
+      state = gps ? NMEA_PARSER : NMEA_BODY;
+      break;
+   case 0xB5:
+      protocol = TinyGPSFrame::UBX;
+      state = UBX_HEADER;
+      break;
+   default:
+      protocol = TinyGPSFrame::RTCM3;
+      state = RTCM_HEADER;
+      break;
+   }
+}
+
+// Frames that arrived in one piece are left where they are. Headers and
+// the NMEA limit keep every frame within the buffer.
+void TinyGPSDemux::take(const uint8_t *p, size_t n)
+{
+   if (!start)
+      memcpy(frame + have, p, n);
+   have += n;
+}
+
+void TinyGPSDemux::finish()
+{
+   ++counter(frames);
+   TinyGPSFrame f;
+   f.protocol = protocol;
+   f.data = bytes();
+   f.length = have;
+   if (protocol == TinyGPSFrame::UBX && gps)
+      gps->ubxFrame(f.data[2], f.data[3], f.payload(), f.payloadLength());
+   if (handler)
+      handler(f, context);
+   abort();
+}
+
+// After a false sync, the search resumes at the byte following it: in
+// buf if the frame began there, else in the assembly buffer, which is
+// fed back in before the search goes on at buf[i]. A status the parser
+// reports meanwhile is passed on.
+size_t TinyGPSDemux::resync(const uint8_t *buf, size_t i, EncodeStatus &status)
+{
+   if (start)
+   {
+      i = (size_t)(start - buf) + 1;
+      abort();
+      return i;
+   }
+   const uint16_t n = have - 1;
+   abort();
+   memmove(frame, frame + 1, n);
+   for (size_t done = 0; done < n;)
+   {
+      size_t used = 0;
+      const EncodeStatus replayed = feed(frame + done, n - done, used);
+      if (replayed != EncodeStatus::UNFINISHED)
+         status = replayed;
+      done += used;
+   }
+   return i;
+}
+
+unsigned int &TinyGPSDemux::counter(Counters &counters) const
+{
+   return protocol == TinyGPSFrame::UBX ? counters.ubx :
+          protocol == TinyGPSFrame::RTCM3 ? counters.rtcm : counters.nmea;
+}
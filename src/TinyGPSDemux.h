@@ -0,0 +1,128 @@
+/*
+TinyGPSDemux - splits a port carrying NMEA, UBX and RTCM3 into verified
+frames, so binary frames never reach the sentence parser.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSDemux_h
+#define __TinyGPSDemux_h
+
+#include "TinyGPS++.h"
+
+// Frames split across feed() calls are assembled here, and a header
+// claiming a longer frame is taken as a false sync. 1029 bytes hold the
+// longest RTCM3 frame; UBX messages larger than that (RXM-RAWX with many
+// observations) need a bigger buffer.
+#ifndef _GPS_DEMUX_FRAME_SIZE
+#define _GPS_DEMUX_FRAME_SIZE 1029
+#endif
+
+// One verified frame, from its sync byte through its checksum. data
+// points into the buffer given to feed() when the frame arrived in one
+// piece; it is valid during the callback only.
+struct TinyGPSFrame
+{
+   enum Protocol : uint8_t { NMEA, UBX, RTCM3 };
+   Protocol protocol;
+   const uint8_t *data;
+   uint16_t length;
+
+   // UBX class << 8 | id, RTCM3 message number, 0 for NMEA
+   uint16_t type() const
+   {
+      return protocol == UBX ? (uint16_t)(data[2] << 8 | data[3]) :
+             protocol == RTCM3 ? (uint16_t)(data[3] << 4 | data[4] >> 4) : 0;
+   }
+   // NMEA: the address and terms, between '$' and '*'
+   const uint8_t *payload() const { return data + (protocol == UBX ? 6 : protocol == RTCM3 ? 3 : 1); }
+   uint16_t payloadLength() const
+   {
+      return length - (protocol == UBX ? 8 : protocol == RTCM3 ? 6 : data[length - 2] == '\r' ? 6 : 5);
+   }
+};
+
+// Between frames only the sync bytes '$', 0xB5 (UBX) and 0xD3 (RTCM3)
+// are of interest; a binary frame is then taken whole by its length and
+// checked by Fletcher-8 or CRC-24Q, so '$' bytes inside it start
+// nothing. Each byte is handled once, except after a false sync: a
+// header that cannot be valid, or a failed checksum, resumes the search
+// at the byte after the sync. A frame that spans feed() calls is
+// searched again from the assembly buffer, so resync does not depend on
+// how the input was split.
+//
+// With a TinyGPSPlus attached, sentences are passed to it as they
+// arrive and it checks them; verified UBX frames reach its listeners
+// (onUbxAck). Otherwise sentences are checked here and delivered like
+// the binary frames.
+class TinyGPSDemux
+{
+public:
+   typedef TinyGPSPlus::EncodeStatus EncodeStatus;
+   typedef void (*FrameHandler)(const TinyGPSFrame &frame, void *context);
+
+   struct Counters
+   {
+      unsigned int nmea{};
+      unsigned int ubx{};
+      unsigned int rtcm{};
+   };
+
+   explicit TinyGPSDemux(TinyGPSPlus *gps = 0, FrameHandler handler = 0, void *context = 0);
+
+   // Like TinyGPSPlus::encodeGiveStatus(): returns after a sentence the
+   // parser reports, with consumed telling how far it got
+   EncodeStatus feed(const uint8_t *buf, size_t len, size_t &consumed);
+   void feed(const uint8_t *buf, size_t len);
+
+   Counters frames;          // verified; with a parser, sentences that passed its checksum
+   Counters checksumErrors;  // NMEA only without a parser; it counts its own
+   unsigned int oversized;   // headers claiming more than _GPS_DEMUX_FRAME_SIZE
+   unsigned int skipped;     // bytes outside frames, line ends included
+
+   static uint8_t xorChecksum(const uint8_t *p, size_t n, uint8_t parity = 0);
+   // ck_a in the low byte, ck_b in the high byte
+   static uint16_t fletcher8(const uint8_t *p, size_t n, uint16_t ck = 0);
+   static uint32_t crc24q(const uint8_t *p, size_t n, uint32_t crc = 0);
+
+private:
+   enum State : uint8_t
+   {
+      IDLE,
+      NMEA_PARSER,    // TinyGPSPlus has the sentence
+      NMEA_BODY,
+      NMEA_CHECKSUM,
+      NMEA_END,
+      UBX_HEADER,
+      RTCM_HEADER,
+      BINARY_BODY
+   };
+   static const uint32_t crc24qNibbles[16];
+
+   TinyGPSPlus *gps;
+   FrameHandler handler;
+   void *context;
+
+   State state;
+   TinyGPSFrame::Protocol protocol;
+   const uint8_t *start;   // the frame in the buffer being fed; 0 once it spans feeds
+   uint16_t have;          // frame bytes so far
+   uint16_t frameLength;   // binary frames, once the header is in
+   uint8_t digits;         // NMEA checksum digits so far
+   uint32_t check;         // running checksum
+   uint32_t expected;      // checksum received
+   uint8_t frame[_GPS_DEMUX_FRAME_SIZE];
+
+   const uint8_t *bytes() const { return start ? start : frame; }
+   void begin(const uint8_t *sync);
+   void take(const uint8_t *p, size_t n);
+   void finish();
+   size_t resync(const uint8_t *buf, size_t i, EncodeStatus &status);
+   void abort() { state = IDLE; start = 0; }
+   unsigned int &counter(Counters &counters) const;
+};
+
+#endif // def(__TinyGPSDemux_h)
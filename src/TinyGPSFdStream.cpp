@@ -0,0 +1,71 @@
+/*
+TinyGPSFdStream - TinyGPSStream over a POSIX file descriptor (tty, pty,
+FIFO or regular file) for Linux hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+// termios and read(2); empty on boards, where the IDE builds every file
+#if defined(__linux__)
+#include "TinyGPSFdStream.h"
+
+#include <errno.h>
+#include <termios.h>
+#include <unistd.h>
+
+size_t TinyGPSFdStream::read(uint8_t *buf, size_t n)
+{
+   ssize_t got;
+   do
+   {
+      got = ::read(fd, buf, n);
+   } while (got < 0 && errno == EINTR);
+   return got > 0 ? (size_t)got : 0;
+}
+
+size_t TinyGPSFdStream::write(const uint8_t *buf, size_t n)
+{
+   size_t done = 0;
+   while (done < n)
+   {
+      ssize_t put = ::write(fd, buf + done, n - done);
+      if (put < 0 && errno == EINTR)
+         continue;
+      if (put <= 0)
+         break;
+      done += put;
+   }
+   return done;
+}
+
+static speed_t toSpeed(uint32_t baud)
+{
+   switch (baud)
+   {
+   case 4800: return B4800;
+   case 9600: return B9600;
+   case 19200: return B19200;
+   case 38400: return B38400;
+   case 57600: return B57600;
+   case 115200: return B115200;
+   case 230400: return B230400;
+   default: return B0;
+   }
+}
+
+void TinyGPSFdStream::setBaudrate(uint32_t baud)
+{
+   struct termios tio;
+   const speed_t speed = toSpeed(baud);
+   if (speed == B0 || tcgetattr(fd, &tio) != 0)
+      return;
+   tcdrain(fd);
+   cfsetispeed(&tio, speed);
+   cfsetospeed(&tio, speed);
+   tcsetattr(fd, TCSANOW, &tio);
+}
+
+#endif // defined(__linux__)
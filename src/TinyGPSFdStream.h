@@ -0,0 +1,32 @@
+/*
+TinyGPSFdStream - TinyGPSStream over a POSIX file descriptor (tty, pty,
+FIFO or regular file) for Linux hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSFdStream_h
+#define __TinyGPSFdStream_h
+
+#include "TinyGPSStream.h"
+
+// Does not own the descriptor. Reads return what one read(2) delivers,
+// so give TinyGPSPlus a large _GPS_RX_BUFFER_SIZE to batch syscalls.
+class TinyGPSFdStream : public TinyGPSStream
+{
+public:
+   explicit TinyGPSFdStream(int _fd) : fd(_fd) {}
+   size_t read(uint8_t *buf, size_t n) override;
+   size_t write(const uint8_t *buf, size_t n) override;
+   // Applies the speed when fd is a terminal; ignored otherwise
+   void setBaudrate(uint32_t baud) override;
+   int descriptor() const { return fd; }
+
+private:
+   int fd;
+};
+
+#endif // def(__TinyGPSFdStream_h)
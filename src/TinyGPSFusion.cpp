@@ -0,0 +1,140 @@
+/*
+TinyGPSFusion - one fix stream from several redundant receivers, taking
+the first acceptable fix of every epoch.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSFusion.h"
+#include "TinyGPSTrack.h"
+
+#define _GPS_CENTIS_PER_DAY 8640000UL
+
+const TinyGPSFusion::ReceiverStats TinyGPSFusion::noStats;
+
+TinyGPSFusion::TinyGPSFusion(Callback _cb, void *_context)
+  :  staleMs(2000)
+  ,  divergeMeters(50)
+  ,  clock(millis)
+  ,  count(0)
+  ,  cb(_cb)
+  ,  context(_context)
+  ,  published(false)
+  ,  epochPublished(false)
+  ,  epoch(0)
+  ,  lastFix()
+{
+}
+
+TinyGPSFusion::~TinyGPSFusion()
+{
+   for (uint8_t i = 0; i < count; ++i)
+      inputs[i].gps->removeListener(&inputs[i]);
+}
+
+int TinyGPSFusion::add(TinyGPSPlus &gps)
+{
+   if (count == _GPS_FUSION_RECEIVERS)
+      return -1;
+   Input &input = inputs[count];
+   input.fusion = this;
+   input.gps = &gps;
+   input.index = count;
+   input.hasFix = false;
+   input.lastFixMs = 0;
+   input.separation = 0;
+   input.stats = ReceiverStats();
+   gps.addListener(&input);
+   return count++;
+}
+
+bool TinyGPSFusion::isStale(uint8_t receiver) const
+{
+   if (receiver >= count)
+      return true;
+   const Input &input = inputs[receiver];
+   return !input.hasFix || clock() - input.lastFixMs > staleMs;
+}
+
+void TinyGPSFusion::Input::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   if (fields & (1u << TinyGPSSnapshot::LOCATION))
+      fusion->candidate(*this, gps);
+}
+
+uint32_t TinyGPSFusion::centisOfDay(uint32_t time)
+{
+   return time / 1000000 * 360000 + time / 10000 % 100 * 6000 + time % 10000;
+}
+
+bool TinyGPSFusion::acceptable(const TinyGPSPlus &gps) const
+{
+   const uint32_t maxAge = criteria.maxQualityAgeMs;
+   if (criteria.maxHdop &&
+      (gps.hdop.age() > maxAge || TinyGPSPlus::rescale(gps.hdop.peek(), TinyGPSHDOP::decimals, 2) > criteria.maxHdop))
+      return false;
+   if (criteria.minSatellites && (gps.satellites.age() > maxAge || gps.satellites.peek() < criteria.minSatellites))
+      return false;
+   if (criteria.require3d && (!gps.gsa.isValid() || !gps.gsa.fixIs3d()))
+      return false;
+   return true;
+}
+
+void TinyGPSFusion::candidate(Input &input, const TinyGPSPlus &gps)
+{
+   input.stats.fixes++;
+   input.hasFix = true;
+   input.lastFixMs = clock();
+
+   const int32_t lat = TinyGPSTrack::toE7(gps.location.peekLat());
+   const int32_t lng = TinyGPSTrack::toE7(gps.location.peekLng());
+   const uint32_t key = centisOfDay(gps.time.peek());
+   // Newer if ahead by less than half a day, so midnight wraps
+   const uint32_t ahead = (key + _GPS_CENTIS_PER_DAY - epoch) % _GPS_CENTIS_PER_DAY;
+
+   if (published && (ahead == 0 || ahead >= _GPS_CENTIS_PER_DAY / 2))
+   {
+      if (ahead == 0 && epochPublished)
+      {
+         input.stats.late++;
+         if (input.index != lastFix.receiver)
+            input.separation = (uint32_t)TinyGPSPlus::distanceBetween(
+               lastFix.lat / 1e7, lastFix.lng / 1e7, lat / 1e7, lng / 1e7,
+               TinyGPSPlus::DistanceModel::EQUIRECTANGULAR);
+         return;
+      }
+      if (ahead != 0)
+      {
+         input.stats.late++;
+         return;
+      }
+      // The current epoch has no acceptable fix yet; this one may be it
+   }
+   else
+   {
+      epoch = key;
+      epochPublished = false;
+   }
+
+   if (!acceptable(gps))
+   {
+      input.stats.rejected++;
+      return;
+   }
+   input.stats.selected++;
+   input.separation = 0;
+   epochPublished = published = true;
+   lastFix.receiver = input.index;
+   lastFix.time = gps.time.peek();
+   lastFix.lat = lat;
+   lastFix.lng = lng;
+   lastFix.hdop = TinyGPSPlus::rescale(gps.hdop.peek(), TinyGPSHDOP::decimals, 2);
+   lastFix.satellites = gps.satellites.peek();
+   lastFix.is3d = gps.gsa.isValid() && gps.gsa.fixIs3d();
+   lastFix.arrival = gps.timestamp.arrival();
+   if (cb)
+      cb(lastFix, context);
+}
@@ -0,0 +1,104 @@
+/*
+TinyGPSFusion - one fix stream from several redundant receivers, taking
+the first acceptable fix of every epoch.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSFusion_h
+#define __TinyGPSFusion_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_FUSION_RECEIVERS 4
+
+struct TinyGPSFusedFix
+{
+   uint8_t receiver;
+   uint32_t time;       // TinyGPSTime::value(), hhmmsscc
+   int32_t lat, lng;    // 1e-7 degrees
+   int32_t hdop;        // hundredths
+   uint32_t satellites;
+   bool is3d;
+   uint32_t arrival;    // millis() when the sentence began
+};
+
+// Every location commit of a receiver is a candidate for the epoch of
+// its UTC time. The first candidate of a new epoch that meets the
+// criteria is published at once; later candidates of the same epoch are
+// only compared with it, giving each receiver's separation from the
+// published fix. Candidates of older epochs are counted as late.
+// Each commit costs O(1) and one distance computation at most.
+class TinyGPSFusion
+{
+public:
+   typedef void (*Callback)(const TinyGPSFusedFix &fix, void *context);
+   typedef unsigned long (*Clock)();
+
+   // A limit of 0 (false) is not checked
+   struct Criteria
+   {
+      uint16_t maxHdop{500};          // hundredths
+      uint8_t minSatellites{4};
+      bool require3d{false};          // needs GSA output
+      uint32_t maxQualityAgeMs{2000}; // older HDOP/satellites/GSA fail the checks above
+   };
+   struct ReceiverStats
+   {
+      uint32_t fixes{};
+      uint32_t selected{};
+      uint32_t rejected{};  // failed the criteria
+      uint32_t late{};      // epoch already published or older
+   };
+
+   TinyGPSFusion(Callback cb = 0, void *context = 0);
+   ~TinyGPSFusion();
+   // Returns the receiver's index, or -1 if _GPS_FUSION_RECEIVERS are attached
+   int add(TinyGPSPlus &gps);
+
+   Criteria criteria;
+   uint32_t staleMs;       // a receiver without a fix for longer is stale
+   uint16_t divergeMeters; // a receiver further from the published fix diverges
+   Clock clock;            // milliseconds for staleMs; millis() by default
+
+   size_t size() const { return count; }
+   bool isValid() const { return published; }
+   const TinyGPSFusedFix &last() const { return lastFix; }
+   // Receivers not added are stale, never diverge and have no stats
+   bool isStale(uint8_t receiver) const;
+   bool isDiverging(uint8_t receiver) const { return separation(receiver) > divergeMeters; }
+   // Metres from the published fix in the last epoch the receiver shared
+   uint32_t separation(uint8_t receiver) const { return receiver < count ? inputs[receiver].separation : 0; }
+   const ReceiverStats &stats(uint8_t receiver) const { return receiver < count ? inputs[receiver].stats : noStats; }
+
+private:
+   struct Input : public TinyGPSListener
+   {
+      void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+      TinyGPSFusion *fusion;
+      TinyGPSPlus *gps;
+      uint8_t index;
+      bool hasFix;
+      uint32_t lastFixMs;
+      uint32_t separation;
+      ReceiverStats stats;
+   };
+   void candidate(Input &input, const TinyGPSPlus &gps);
+   bool acceptable(const TinyGPSPlus &gps) const;
+   static uint32_t centisOfDay(uint32_t time);
+   static const ReceiverStats noStats;
+
+   Input inputs[_GPS_FUSION_RECEIVERS];
+   uint8_t count;
+   Callback cb;
+   void *context;
+   bool published;          // lastFix is set
+   bool epochPublished;     // the current epoch has its fix
+   uint32_t epoch;          // centiseconds of day
+   TinyGPSFusedFix lastFix;
+};
+
+#endif // def(__TinyGPSFusion_h)
@@ -0,0 +1,188 @@
+/*
+TinyGPSHub - epoll-driven service feeding one TinyGPSPlus per attached
+receiver on Linux hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+// epoll and AF_UNIX sockets: a host-side component
+#if defined(__linux__)
+#include "TinyGPSHub.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#define _GPS_HUB_MAX_EVENTS 64
+
+TinyGPSHub::TinyGPSHub()
+  :  epollFd(-1)
+  ,  outputFd(-1)
+  ,  wakeupUs(0)
+{
+}
+
+TinyGPSHub::~TinyGPSHub()
+{
+   for (size_t i = 0; i < devices.size(); ++i)
+      if (!devices[i]->stats.closed)
+         close(devices[i]->stream.descriptor());
+   if (outputFd >= 0)
+      close(outputFd);
+   if (epollFd >= 0)
+      close(epollFd);
+}
+
+bool TinyGPSHub::begin(const char *path)
+{
+   epollFd = epoll_create1(EPOLL_CLOEXEC);
+   if (epollFd < 0)
+      return false;
+   if (path == NULL)
+      return true;
+   if (strlen(path) >= sizeof(((sockaddr_un *)0)->sun_path))
+      return false;
+   outputPath.assign(path, path + strlen(path) + 1);
+   outputFd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+   return outputFd >= 0;
+}
+
+int TinyGPSHub::addDevice(const char *path, uint32_t baud)
+{
+   // O_RDWR keeps a FIFO open when its writer goes away
+   const int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+   if (fd < 0)
+      return -1;
+
+   struct termios tio;
+   if (isatty(fd) && tcgetattr(fd, &tio) == 0)
+   {
+      cfmakeraw(&tio);
+      tio.c_cflag |= CLOCAL | CREAD;
+      tio.c_cc[VMIN] = 0;
+      tio.c_cc[VTIME] = 0;
+      tcsetattr(fd, TCSANOW, &tio);
+   }
+
+   const int index = (int)devices.size();
+   devices.push_back(std::unique_ptr<Device>(new Device(*this, index, fd)));
+   devices.back()->stream.setBaudrate(baud);
+
+   struct epoll_event ev;
+   memset(&ev, 0, sizeof(ev));
+   ev.events = EPOLLIN;
+   ev.data.u32 = index;
+   if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+   {
+      close(fd);
+      devices.pop_back();
+      return -1;
+   }
+   return index;
+}
+
+int TinyGPSHub::poll(int timeoutMs)
+{
+   struct epoll_event events[_GPS_HUB_MAX_EVENTS];
+   int ready;
+   do
+   {
+      ready = epoll_wait(epollFd, events, _GPS_HUB_MAX_EVENTS, timeoutMs);
+   } while (ready < 0 && errno == EINTR);
+   if (ready < 0)
+      return -1;
+
+   wakeupUs = monotonicUs();
+   for (int i = 0; i < ready; ++i)
+   {
+      Device &device = *devices[events[i].data.u32];
+      // Level-triggered EPOLLHUP/EPOLLERR fire on every wait, and reads
+      // return nothing: read what is left, then stop polling the device
+      const bool hungUp = (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+      while (device.gps.readSerial() && hungUp)
+         ;
+      device.stats.bytes = device.gps.charsProcessed();
+      device.stats.sentences = device.gps.passedChecksum();
+      device.stats.failed = device.gps.failedChecksum();
+      if (hungUp)
+         closeDevice(device);
+   }
+   return ready;
+}
+
+void TinyGPSHub::closeDevice(Device &device)
+{
+   const int fd = device.stream.descriptor();
+   epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+   close(fd);
+   device.stats.closed = true;
+}
+
+TinyGPSHub::DeviceStats TinyGPSHub::stats(int device) const
+{
+   return devices[device]->stats;
+}
+
+uint64_t TinyGPSHub::monotonicUs()
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void TinyGPSHub::publish(Device &device)
+{
+   DeviceStats &stats = device.stats;
+   stats.fixes++;
+
+   if (outputFd >= 0)
+   {
+      TinyGPSSnapshot snap;
+      device.gps.snapshot(snap);
+      char line[128];
+      const int len = snprintf(line, sizeof(line), "%d,%lu,%lu,%.7f,%.7f,%lu,%ld\n",
+         device.index, (unsigned long)snap.date, (unsigned long)snap.time,
+         snap.lat(), snap.lng(), (unsigned long)snap.satellites,
+         (long)TinyGPSPlus::rescale(snap.hdop, TinyGPSHDOP::decimals, 2));
+
+      struct sockaddr_un addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      memcpy(addr.sun_path, &outputPath[0], outputPath.size());
+      if (sendto(outputFd, line, len, MSG_DONTWAIT, (const sockaddr *)&addr, sizeof(addr)) != len)
+         stats.dropped++;
+   }
+
+   const uint64_t latency = monotonicUs() - wakeupUs;
+   stats.latencyLastUs = (uint32_t)latency;
+   if (stats.latencyLastUs > stats.latencyMaxUs)
+      stats.latencyMaxUs = stats.latencyLastUs;
+   stats.latencyTotalUs += latency;
+}
+
+TinyGPSHub::Device::Device(TinyGPSHub &_hub, int _index, int fd)
+  :  hub(_hub)
+  ,  index(_index)
+  ,  stream(fd)
+  ,  gps(stream)
+{
+   gps.addListener(this);
+}
+
+void TinyGPSHub::Device::onCommit(const TinyGPSPlus &, uint16_t fields)
+{
+   if (fields & (1u << TinyGPSSnapshot::LOCATION))
+      hub.publish(*this);
+}
+
+#endif // defined(__linux__)
@@ -0,0 +1,76 @@
+/*
+TinyGPSHub - epoll-driven service feeding one TinyGPSPlus per attached
+receiver on Linux hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSHub_h
+#define __TinyGPSHub_h
+
+#include "TinyGPS++.h"
+#include "TinyGPSFdStream.h"
+#include <memory>
+#include <vector>
+
+// Multiplexes many serial TTYs/PTYs/FIFOs on one thread. Every location
+// commit is sent as one CSV datagram to a local (AF_UNIX) socket:
+//   device,date,time,lat,lng,satellites,hdop
+// with hdop in hundredths whatever _GPS_DOP_DECIMALS is.
+class TinyGPSHub
+{
+public:
+   struct DeviceStats
+   {
+      uint32_t bytes{};
+      uint32_t sentences{};
+      uint32_t failed{};
+      uint32_t fixes{};
+      uint32_t dropped{};       // fixes the output socket did not accept
+      uint32_t latencyLastUs{}; // wakeup to fix publication
+      uint32_t latencyMaxUs{};
+      uint64_t latencyTotalUs{};
+      bool closed{};            // hung up or failed; no longer polled
+   };
+
+   TinyGPSHub();
+   ~TinyGPSHub();
+   // outputPath names a datagram socket bound by the consumer; may be null
+   bool begin(const char *outputPath);
+   // Opens and configures (raw 8N1) a device; returns its index or -1
+   int addDevice(const char *path, uint32_t baud);
+   // Waits up to timeoutMs and services every readable device once;
+   // returns the number of devices serviced or -1 on error. A device
+   // that hangs up (TTY hangup, USB unplug) is drained and closed.
+   int poll(int timeoutMs);
+
+   size_t deviceCount() const { return devices.size(); }
+   TinyGPSPlus &gps(int device) { return devices[device]->gps; }
+   DeviceStats stats(int device) const;
+
+private:
+   struct Device : public TinyGPSListener
+   {
+      Device(TinyGPSHub &hub, int index, int fd);
+      void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+      TinyGPSHub &hub;
+      int index;
+      TinyGPSFdStream stream;
+      TinyGPSPlus gps;
+      DeviceStats stats;
+   };
+   static uint64_t monotonicUs();
+   void publish(Device &device);
+   void closeDevice(Device &device);
+
+   int epollFd;
+   int outputFd;
+   std::vector<char> outputPath;
+   uint64_t wakeupUs;
+   std::vector<std::unique_ptr<Device> > devices;
+};
+
+#endif // def(__TinyGPSHub_h)
@@ -0,0 +1,210 @@
+/*
+TinyGPSPlanner - fits the NMEA output of a u-blox receiver to the serial
+link: sentence set, measurement period and baud rate.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSPlanner.h"
+#include "TinyGPSWriter.h"
+
+namespace
+{
+struct SentenceInfo
+{
+   uint16_t bit;
+   const char *id;
+   unsigned int TinyGPSPlus::Stats::*count;
+   uint16_t typicalBytes; // per epoch, u-blox 6 with a fix
+   bool offByDefault;     // only switched on, as older receivers lack it
+};
+
+const SentenceInfo sentenceInfo[] =
+{
+   {TinyGPSPlanner::RMC, "RMC", &TinyGPSPlus::Stats::rmc, 70, false},
+   {TinyGPSPlanner::GGA, "GGA", &TinyGPSPlus::Stats::gga, 75, false},
+   {TinyGPSPlanner::GSA, "GSA", &TinyGPSPlus::Stats::gsa, 60, false},
+   {TinyGPSPlanner::GSV, "GSV", &TinyGPSPlus::Stats::gsv, 210, false}, // 3 messages
+   {TinyGPSPlanner::VTG, "VTG", &TinyGPSPlus::Stats::vtg, 40, false},
+   {TinyGPSPlanner::GLL, "GLL", &TinyGPSPlus::Stats::gll, 52, false},
+   {TinyGPSPlanner::ZDA, "ZDA", &TinyGPSPlus::Stats::zda, 38, true},
+   {TinyGPSPlanner::GST, "GST", &TinyGPSPlus::Stats::gst, 62, true},
+   {TinyGPSPlanner::GNS, "GNS", &TinyGPSPlus::Stats::gns, 80, true}
+};
+
+const uint16_t dropOrder[] =
+{
+   TinyGPSPlanner::GSV, TinyGPSPlanner::GLL, TinyGPSPlanner::VTG,
+   TinyGPSPlanner::GST, TinyGPSPlanner::ZDA, TinyGPSPlanner::GSA
+};
+
+const uint32_t baudRates[] = {9600, 19200, 38400, 57600, 115200};
+}
+
+TinyGPSPlanner::TinyGPSPlanner(TinyGPSPlus &_gps, uint32_t baud)
+  :  gps(_gps)
+  ,  baudrate(baud)
+  ,  lastChars(_gps.charsProcessed())
+  ,  lastTime(millis())
+  ,  switchedOn(0)
+{
+}
+
+uint32_t TinyGPSPlanner::bytesPerEpoch(uint16_t sentences) const
+{
+   // Sentences sent once per epoch give the number of epochs seen
+   const TinyGPSPlus::Stats &stats = gps.stats;
+   unsigned int epochs = stats.rmc;
+   const unsigned int once[] = {stats.gga, stats.gns, stats.vtg, stats.gll, stats.zda};
+   for (unsigned int n : once)
+      if (n > epochs)
+         epochs = n;
+
+   uint32_t bytes = 0;
+   for (const SentenceInfo &info : sentenceInfo)
+   {
+      if (!(sentences & info.bit))
+         continue;
+      if (epochs != 0 && stats.*info.count != 0)
+         bytes += (gps.sentenceBytes.*info.count + epochs - 1) / epochs;
+      else
+         bytes += info.typicalBytes;
+   }
+   return bytes;
+}
+
+/* static */
+uint8_t TinyGPSPlanner::utilisation(uint32_t bytes, uint32_t periodMs, uint32_t baud)
+{
+   // 10 bits per byte with one start and one stop bit
+   const uint64_t capacity = (uint64_t)baud * periodMs / 10000;
+   if (capacity == 0)
+      return 255;
+   const uint64_t percent = (uint64_t)bytes * 100 / capacity;
+   return percent > 255 ? 255 : (uint8_t)percent;
+}
+
+TinyGPSPlan TinyGPSPlanner::plan(uint16_t sentences, uint16_t periodMs, uint32_t maxBaud) const
+{
+   TinyGPSPlan plan;
+   plan.sentences = sentences;
+   plan.periodMs = periodMs;
+   size_t dropped = 0;
+   for (;;)
+   {
+      plan.bytesPerEpoch = bytesPerEpoch(plan.sentences);
+      // Keep the current rate if it is enough, else the lowest that is
+      plan.baud = baudrate;
+      plan.utilisation = utilisation(plan.bytesPerEpoch, plan.periodMs, plan.baud);
+      for (uint32_t rate : baudRates)
+      {
+         if (plan.utilisation <= _GPS_PLAN_MAX_LOAD)
+            break;
+         if (rate <= baudrate || rate > maxBaud)
+            continue;
+         plan.baud = rate;
+         plan.utilisation = utilisation(plan.bytesPerEpoch, plan.periodMs, plan.baud);
+      }
+      plan.feasible = plan.utilisation <= _GPS_PLAN_MAX_LOAD;
+      if (plan.feasible)
+         return plan;
+
+      if (dropped < sizeof(dropOrder) / sizeof(dropOrder[0]))
+      {
+         plan.sentences &= ~dropOrder[dropped++];
+         continue;
+      }
+      if (plan.periodMs * 2 > _GPS_PLAN_MAX_PERIOD_MS)
+         return plan;
+      plan.periodMs *= 2;
+   }
+}
+
+void TinyGPSPlanner::apply(const TinyGPSPlan &plan)
+{
+   if (plan.baud != baudrate)
+   {
+      // The receiver switches once the sentence has left the UART
+      const size_t length = sendPubx41(plan.baud);
+      delay(((uint32_t)length * 10000 + baudrate - 1) / baudrate);
+      gps.setStreamBaudrate(plan.baud);
+      baudrate = plan.baud;
+   }
+   for (const SentenceInfo &info : sentenceInfo)
+      if ((plan.sentences & info.bit) || !info.offByDefault || (switchedOn & info.bit))
+         sendPubx40(info.id, (plan.sentences & info.bit) != 0);
+   switchedOn = plan.sentences;
+   sendRate(plan.periodMs);
+}
+
+uint8_t TinyGPSPlanner::measuredUtilisation()
+{
+   const uint32_t chars = gps.charsProcessed();
+   const uint32_t now = millis();
+   const uint8_t ret = utilisation(chars - lastChars, now - lastTime, baudrate);
+   lastChars = chars;
+   lastTime = now;
+   return ret;
+}
+
+// sendByteSentence appends the CRLF, so the writer's is left out
+void TinyGPSPlanner::sendPubx40(const char *id, bool on)
+{
+   char buf[40];
+   TinyGPSWriter w(buf, sizeof(buf));
+   w.beginSentence();
+   w.put("PUBX,40,");
+   w.put(id);
+   w.put(on ? ",0,1,0,0,0,0" : ",0,0,0,0,0,0");
+   w.endSentence();
+   gps.sendByteSentence((const uint8_t *)w.c_str(), w.length() - 2);
+}
+
+size_t TinyGPSPlanner::pubx41(uint32_t baud, char *buf, size_t size)
+{
+   TinyGPSWriter w(buf, size);
+   w.beginSentence();
+   w.put("PUBX,41,1,0007,0003,");
+   w.unsignedInt(baud);
+   w.put(",0");
+   w.endSentence();
+   return w.length() - 2;
+}
+
+// Returns the bytes sent, CRLF included
+size_t TinyGPSPlanner::sendPubx41(uint32_t baud)
+{
+   char buf[48];
+   const size_t length = pubx41(baud, buf, sizeof(buf));
+   gps.sendByteSentence((const uint8_t *)buf, length);
+   return length + 2;
+}
+
+// UBX CFG-RATE: measurement period, one solution per measurement, GPS time
+void TinyGPSPlanner::rateFrame(uint16_t periodMs, uint8_t *frame)
+{
+   const uint8_t header[12] = {0xB5, 0x62, 0x06, 0x08, 0x06, 0x00,
+                               (uint8_t)(periodMs & 0xFF), (uint8_t)(periodMs >> 8), 0x01, 0x00, 0x01, 0x00};
+   uint8_t a = 0, b = 0;
+   for (size_t i = 0; i < 12; ++i)
+   {
+      frame[i] = header[i];
+      if (i >= 2)
+      {
+         a += frame[i];
+         b += a;
+      }
+   }
+   frame[12] = a;
+   frame[13] = b;
+}
+
+void TinyGPSPlanner::sendRate(uint16_t periodMs)
+{
+   uint8_t frame[14];
+   rateFrame(periodMs, frame);
+   gps.sendByteSentence(frame, sizeof(frame));
+}
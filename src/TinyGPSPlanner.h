@@ -0,0 +1,85 @@
+/*
+TinyGPSPlanner - fits the NMEA output of a u-blox receiver to the serial
+link: sentence set, measurement period and baud rate.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSPlanner_h
+#define __TinyGPSPlanner_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_PLAN_MAX_LOAD 85 // percent of the link a plan may use
+#define _GPS_PLAN_MAX_PERIOD_MS 10000
+
+struct TinyGPSPlan
+{
+   uint16_t sentences;     // TinyGPSPlanner::Sentence bits
+   uint16_t periodMs;
+   uint32_t baud;
+   uint32_t bytesPerEpoch;
+   uint8_t utilisation;    // percent of the link, 8N1
+   bool feasible;          // utilisation <= _GPS_PLAN_MAX_LOAD
+};
+
+// Sentence sizes come from TinyGPSPlus::sentenceBytes once sentences have
+// been received, typical u-blox 6 sizes before that. A plan keeps the
+// requested sentences and period if a baud rate up to maxBaud carries
+// them; otherwise it drops GSV, GLL, VTG, GST, ZDA and GSA in that order
+// and then lengthens the period. RMC, GGA and GNS are never dropped.
+class TinyGPSPlanner
+{
+public:
+   enum Sentence : uint16_t
+   {
+      RMC = 1 << 0,
+      GGA = 1 << 1,
+      GSA = 1 << 2,
+      GSV = 1 << 3,
+      VTG = 1 << 4,
+      GLL = 1 << 5,
+      ZDA = 1 << 6,
+      GST = 1 << 7,
+      GNS = 1 << 8,
+      ALL = (1 << 9) - 1
+   };
+
+   // baud: the rate the link runs at now
+   TinyGPSPlanner(TinyGPSPlus &gps, uint32_t baud);
+
+   uint32_t bytesPerEpoch(uint16_t sentences) const;
+   static uint8_t utilisation(uint32_t bytes, uint32_t periodMs, uint32_t baud);
+   TinyGPSPlan plan(uint16_t sentences, uint16_t periodMs, uint32_t maxBaud = 115200) const;
+   // Sends $PUBX,41 if the baud rate changes, blocking until it has left
+   // the UART before switching the local side (see TinyGPSCommands for a
+   // non-blocking queue); $PUBX,40 for every sentence, except ZDA, GST
+   // and GNS when they are off and were not switched on by an earlier
+   // plan; and UBX CFG-RATE
+   void apply(const TinyGPSPlan &plan);
+
+   uint32_t baud() const { return baudrate; }
+   // Share of the link used by received bytes since the previous call
+   uint8_t measuredUtilisation();
+   // Fills the 14 bytes of a UBX CFG-RATE frame
+   static void rateFrame(uint16_t periodMs, uint8_t *frame);
+   // Writes $PUBX,41 for UART1 at 'baud', UBX+NMEA+RTCM in, UBX+NMEA
+   // out; returns its length without the CRLF, as sendByteSentence takes it
+   static size_t pubx41(uint32_t baud, char *buf, size_t size);
+
+private:
+   void sendPubx40(const char *id, bool on);
+   size_t sendPubx41(uint32_t baud);
+   void sendRate(uint16_t periodMs);
+
+   TinyGPSPlus &gps;
+   uint32_t baudrate;
+   uint32_t lastChars;
+   uint32_t lastTime;
+   uint16_t switchedOn;    // sentences of the last plan applied
+};
+
+#endif // def(__TinyGPSPlanner_h)
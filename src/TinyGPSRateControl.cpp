@@ -0,0 +1,168 @@
+/*
+TinyGPSRateControl - switches the measurement period of a u-blox
+receiver with the motion of the asset.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSRateControl.h"
+#include "TinyGPSCommands.h"
+#include "TinyGPSPlanner.h"
+#include "TinyGPSTrack.h"
+
+#define _GPS_MS_PER_DAY 86400000UL
+
+TinyGPSRateControl::TinyGPSRateControl(TinyGPSPlus &_gps, TinyGPSCommands *_commands)
+  :  hysteresis(100)
+  ,  holdMs(10000)
+  ,  turnRate(1500)
+  ,  turnLevel(_GPS_RATE_LEVELS - 1)
+  ,  movingSpeed(200)
+  ,  approachMeters(100)
+  ,  gps(_gps)
+  ,  commands(_commands)
+  ,  levelCount(0)
+  ,  fenceCount(0)
+  ,  current(0)
+  ,  pending(0)
+  ,  lowering(false)
+  ,  lowerSince(0)
+  ,  hasCourse(false)
+  ,  lastCourse(0)
+  ,  lastCourseMs(0)
+  ,  switchCount(0)
+{
+   gps.addListener(this);
+}
+
+TinyGPSRateControl::~TinyGPSRateControl()
+{
+   gps.removeListener(this);
+}
+
+bool TinyGPSRateControl::addLevel(uint16_t periodMs, uint16_t speed)
+{
+   if (levelCount == _GPS_RATE_LEVELS || (levelCount && speed <= levels[levelCount - 1].speed))
+      return false;
+   Level &level = levels[levelCount];
+   level.periodMs = periodMs;
+   level.speed = speed;
+   TinyGPSPlanner::rateFrame(periodMs, level.frame);
+   // No level is selected before the first fix
+   if (current == levelCount)
+      ++current;
+   ++levelCount;
+   return true;
+}
+
+bool TinyGPSRateControl::addGeofence(int32_t latE7, int32_t lngE7, uint16_t radiusMeters, uint8_t level)
+{
+   if (fenceCount == _GPS_RATE_FENCES)
+      return false;
+   fences[fenceCount++] = Geofence{latE7, lngE7, radiusMeters, level};
+   return true;
+}
+
+void TinyGPSRateControl::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   if (!levelCount || !(fields & (1u << TinyGPSSnapshot::SPEED)) || !gps.time.isValid())
+      return;
+   const uint32_t now = msOfDay(gps.time.peek());
+   const int32_t speed = TinyGPSPlus::rescale(gps.speed.peek(), TinyGPSSpeed::decimals, 2);
+   const uint8_t wanted = demand(gps, speed, now);
+
+   if (!isValid() || wanted > current)
+   {
+      lowering = false;
+      select(wanted);
+   }
+   else if (wanted == current)
+      lowering = false;
+   else if (!lowering)
+   {
+      lowering = true;
+      lowerSince = now;
+      pending = wanted;
+   }
+   else
+   {
+      if (wanted > pending)
+         pending = wanted;
+      if (elapsed(lowerSince, now) >= holdMs)
+      {
+         lowering = false;
+         select(pending);
+      }
+   }
+}
+
+uint8_t TinyGPSRateControl::demand(const TinyGPSPlus &gps, int32_t speed, uint32_t now)
+{
+   uint8_t wanted = 0;
+   for (uint8_t i = 1; i < levelCount; ++i)
+   {
+      // The current level and those below it are kept down to the hysteresis
+      const int32_t threshold = isValid() && i <= current ? (int32_t)levels[i].speed - hysteresis : levels[i].speed;
+      if (speed >= threshold)
+         wanted = i;
+   }
+
+   if (speed >= movingSpeed)
+   {
+      const int32_t course = TinyGPSPlus::rescale(gps.course.peek(), TinyGPSCourse::decimals, 2);
+      if (hasCourse && now != lastCourseMs)
+      {
+         int32_t turn = (course - lastCourse + 54000) % 36000 - 18000; // -180..180 degrees
+         if (turn < 0)
+            turn = -turn;
+         // 64-bit: after an outage of 48 min the product overflows 32 bits
+         if ((uint64_t)turn * 1000 >= (uint64_t)turnRate * elapsed(lastCourseMs, now) && turnLevel > wanted)
+            wanted = turnLevel;
+      }
+      hasCourse = true;
+      lastCourse = course;
+      lastCourseMs = now;
+   }
+   else
+      hasCourse = false;
+
+   if (fenceCount)
+   {
+      const double lat = TinyGPSTrack::toE7(gps.location.peekLat()) / 1e7;
+      const double lng = TinyGPSTrack::toE7(gps.location.peekLng()) / 1e7;
+      for (uint8_t i = 0; i < fenceCount; ++i)
+      {
+         const Geofence &f = fences[i];
+         if (f.level > wanted &&
+            TinyGPSPlus::distanceBetween(lat, lng, f.lat / 1e7, f.lng / 1e7, TinyGPSPlus::DistanceModel::EQUIRECTANGULAR) <=
+               (double)f.radius + approachMeters)
+            wanted = f.level;
+      }
+   }
+   return wanted < levelCount ? wanted : levelCount - 1;
+}
+
+void TinyGPSRateControl::select(uint8_t level)
+{
+   if (level == current)
+      return;
+   current = level;
+   ++switchCount;
+   const Level &l = levels[level];
+   if (!commands || !commands->ubx(l.frame, sizeof(l.frame)))
+      gps.sendByteSentence(l.frame, sizeof(l.frame));
+}
+
+uint32_t TinyGPSRateControl::msOfDay(uint32_t time)
+{
+   return (time / 1000000 * 3600 + time / 10000 % 100 * 60 + time / 100 % 100) * 1000 + time % 100 * 10;
+}
+
+// Across midnight as well
+uint32_t TinyGPSRateControl::elapsed(uint32_t from, uint32_t to)
+{
+   return (to + _GPS_MS_PER_DAY - from) % _GPS_MS_PER_DAY;
+}
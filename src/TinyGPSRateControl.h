@@ -0,0 +1,92 @@
+/*
+TinyGPSRateControl - switches the measurement period of a u-blox
+receiver with the motion of the asset.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSRateControl_h
+#define __TinyGPSRateControl_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_RATE_LEVELS 4
+#define _GPS_RATE_FENCES 4
+
+class TinyGPSCommands;
+
+// Every RMC with a fix demands the fastest level that one of these
+// conditions asks for:
+//  - speed: a level is entered at its speed and left below it minus
+//    'hysteresis'
+//  - turning faster than 'turnRate' while moving: 'turnLevel'
+//  - within 'approachMeters' of a geofence: the fence's level
+// A higher demand switches at once; a lower one must persist for
+// 'holdMs' and then switches to the highest level demanded meanwhile.
+// Each switch sends UBX CFG-RATE, through the command queue if one is
+// given, so that it is retried until acknowledged. Hold and turn times
+// are taken from the fixes' UTC time, not from when they were read.
+class TinyGPSRateControl : public TinyGPSListener
+{
+public:
+   explicit TinyGPSRateControl(TinyGPSPlus &gps, TinyGPSCommands *commands = 0);
+   ~TinyGPSRateControl();
+
+   // From slowest to fastest; speed in 0.01 knots. False when full or
+   // out of order.
+   bool addLevel(uint16_t periodMs, uint16_t speed);
+   bool addGeofence(int32_t latE7, int32_t lngE7, uint16_t radiusMeters, uint8_t level);
+
+   uint16_t hysteresis;     // 0.01 knots
+   uint32_t holdMs;
+   uint16_t turnRate;       // 0.01 degrees per second
+   uint8_t turnLevel;
+   uint16_t movingSpeed;    // 0.01 knots; course is ignored below
+   uint16_t approachMeters; // outside the fence radius
+
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+
+   bool isValid() const { return current < levelCount; }
+   uint8_t level() const { return current; }
+   uint16_t periodMs() const { return isValid() ? levels[current].periodMs : 0; }
+   uint32_t switches() const { return switchCount; }
+
+private:
+   struct Level
+   {
+      uint16_t periodMs;
+      uint16_t speed;
+      uint8_t frame[14]; // CFG-RATE, kept for the command queue
+   };
+   struct Geofence
+   {
+      int32_t lat, lng;
+      uint16_t radius;
+      uint8_t level;
+   };
+   uint8_t demand(const TinyGPSPlus &gps, int32_t speed, uint32_t now);
+   void select(uint8_t level);
+   static uint32_t msOfDay(uint32_t time);
+   static uint32_t elapsed(uint32_t from, uint32_t to);
+
+   TinyGPSPlus &gps;
+   TinyGPSCommands *commands;
+   Level levels[_GPS_RATE_LEVELS];
+   uint8_t levelCount;
+   Geofence fences[_GPS_RATE_FENCES];
+   uint8_t fenceCount;
+
+   uint8_t current;         // levelCount until the first fix
+   uint8_t pending;         // highest lower demand since lowerSince
+   bool lowering;
+   uint32_t lowerSince;     // ms of day, as the times below
+   bool hasCourse;
+   int32_t lastCourse;
+   uint32_t lastCourseMs;
+   uint32_t switchCount;
+};
+
+#endif // def(__TinyGPSRateControl_h)
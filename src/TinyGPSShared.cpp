@@ -0,0 +1,70 @@
+/*
+TinyGPSShared - lock-free publication of TinyGPS++ state to reader threads
+for multi-threaded (Linux) hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSShared.h"
+
+#include <string.h>
+
+TinyGPSShared::TinyGPSShared()
+  :  seq(0)
+{
+   uint32_t words[WORDS] = {};
+   memcpy(words, &staging, sizeof(staging));
+   for (size_t i = 0; i < WORDS; ++i)
+      payload[i].store(words[i], std::memory_order_relaxed);
+}
+
+void TinyGPSShared::onCommit(const TinyGPSPlus &gps, uint16_t)
+{
+   gps.snapshot(staging);
+
+   uint32_t words[WORDS] = {};
+   memcpy(words, &staging, sizeof(staging));
+
+   // Odd sequence marks a publish in progress
+   const uint32_t s = seq.load(std::memory_order_relaxed);
+   seq.store(s + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   for (size_t i = 0; i < WORDS; ++i)
+      payload[i].store(words[i], std::memory_order_relaxed);
+   seq.store(s + 2, std::memory_order_release);
+}
+
+void TinyGPSShared::load(TinyGPSSnapshot &snap) const
+{
+   uint32_t words[WORDS];
+   uint32_t before, after;
+   do
+   {
+      before = seq.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORDS; ++i)
+         words[i] = payload[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = seq.load(std::memory_order_relaxed);
+   } while ((before & 1) || before != after);
+   memcpy(&snap, words, sizeof(snap));
+}
+
+TinyGPSReader::TinyGPSReader(const TinyGPSShared &_shared)
+  :  shared(_shared)
+{
+   memset(seen, 0, sizeof(seen));
+}
+
+const TinyGPSSnapshot &TinyGPSReader::read()
+{
+   shared.load(snap);
+   return snap;
+}
+
+void TinyGPSReader::acknowledgeAll()
+{
+   memcpy(seen, snap.version, sizeof(seen));
+}
@@ -0,0 +1,61 @@
+/*
+TinyGPSShared - lock-free publication of TinyGPS++ state to reader threads
+for multi-threaded (Linux) hosts.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSShared_h
+#define __TinyGPSShared_h
+
+#include "TinyGPS++.h"
+#include <atomic>
+
+// Seqlock holding the latest committed TinyGPSSnapshot. Register it with
+// TinyGPSPlus::addListener() on the parser thread; the parser never waits
+// for readers. Readers copy the payload and retry only if a publish
+// overlapped the copy.
+//
+// Only the snapshot is safe to read from other threads. The satellite
+// table (ids and SNRs; the snapshot has the count), the timestamp, GST
+// and TXT are not in it, and reading them off the parser thread races
+// with decoding. Copy them out in a listener's onCommit() and hand them
+// over under a lock of your own; a timestamp can also be rebuilt from
+// the snapshot's date and time with TinyGPSTimestamp::daysFromCivil().
+class TinyGPSShared : public TinyGPSListener
+{
+public:
+   TinyGPSShared();
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+   void load(TinyGPSSnapshot &snap) const;
+   uint32_t sequence() const { return seq.load(std::memory_order_acquire); }
+
+private:
+   static const size_t WORDS = (sizeof(TinyGPSSnapshot) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+   std::atomic<uint32_t> seq;
+   std::atomic<uint32_t> payload[WORDS];
+   TinyGPSSnapshot staging; // parser thread only
+};
+
+// Per-thread view of a TinyGPSShared. Update tracking is private to the
+// reader, so several readers can consume the same commits independently.
+class TinyGPSReader
+{
+public:
+   explicit TinyGPSReader(const TinyGPSShared &shared);
+   const TinyGPSSnapshot &read();
+   const TinyGPSSnapshot &snapshot() const { return snap; }
+   bool isUpdated(TinyGPSSnapshot::Field f) const { return snap.version[f] != seen[f]; }
+   void acknowledge(TinyGPSSnapshot::Field f) { seen[f] = snap.version[f]; }
+   void acknowledgeAll();
+
+private:
+   const TinyGPSShared &shared;
+   TinyGPSSnapshot snap;
+   uint32_t seen[TinyGPSSnapshot::FIELD_COUNT];
+};
+
+#endif // def(__TinyGPSShared_h)
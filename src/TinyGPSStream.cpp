@@ -0,0 +1,43 @@
+/*
+TinyGPSStream - byte source/sink abstraction used by TinyGPS++ to talk to
+a receiver.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSStream.h"
+
+#include <string.h>
+
+TinyGPSMemoryStream::TinyGPSMemoryStream(const uint8_t *_input, size_t _inputLength, uint8_t *_output, size_t _outputCapacity)
+  :  input(_input)
+  ,  inputLength(_inputLength)
+  ,  inputPos(0)
+  ,  output(_output)
+  ,  outputCapacity(_outputCapacity)
+  ,  outputLength(0)
+  ,  baudrate(0)
+{
+}
+
+size_t TinyGPSMemoryStream::read(uint8_t *buf, size_t n)
+{
+   if (n > remaining())
+      n = remaining();
+   memcpy(buf, input + inputPos, n);
+   inputPos += n;
+   return n;
+}
+
+size_t TinyGPSMemoryStream::write(const uint8_t *buf, size_t n)
+{
+   if (n > outputCapacity - outputLength)
+      n = outputCapacity - outputLength;
+   if (n)
+      memcpy(output + outputLength, buf, n);
+   outputLength += n;
+   return n;
+}
@@ -0,0 +1,77 @@
+/*
+TinyGPSStream - byte source/sink abstraction used by TinyGPS++ to talk to
+a receiver.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSStream_h
+#define __TinyGPSStream_h
+
+#include "Arduino.h"
+#include <stddef.h>
+
+class TinyGPSStream
+{
+public:
+   virtual ~TinyGPSStream() {}
+   // Reads up to n bytes that are available now; never blocks
+   virtual size_t read(uint8_t *buf, size_t n) = 0;
+   virtual size_t write(const uint8_t *buf, size_t n) = 0;
+   virtual void setBaudrate(uint32_t baud) = 0;
+};
+
+// Any Arduino Stream with begin()/end() (HardwareSerial, SoftwareSerial)
+template <class SerialT>
+class TinyGPSSerialStream : public TinyGPSStream
+{
+public:
+   explicit TinyGPSSerialStream(SerialT &_serial) : serial(_serial) {}
+   size_t read(uint8_t *buf, size_t n) override
+   {
+      size_t count = 0;
+      while (count < n && serial.available())
+         buf[count++] = (uint8_t)serial.read();
+      return count;
+   }
+   size_t write(const uint8_t *buf, size_t n) override
+   {
+      for (size_t i = 0; i < n; ++i)
+         serial.write(buf[i]);
+      return n;
+   }
+   void setBaudrate(uint32_t baud) override
+   {
+      serial.end();
+      serial.begin(baud);
+   }
+
+private:
+   SerialT &serial;
+};
+
+// Replays a caller-owned buffer and captures output into another one
+class TinyGPSMemoryStream : public TinyGPSStream
+{
+public:
+   TinyGPSMemoryStream(const uint8_t *input, size_t inputLength, uint8_t *output = 0, size_t outputCapacity = 0);
+   size_t read(uint8_t *buf, size_t n) override;
+   size_t write(const uint8_t *buf, size_t n) override;
+   void setBaudrate(uint32_t baud) override { baudrate = baud; }
+
+   size_t remaining() const { return inputLength - inputPos; }
+   size_t written() const { return outputLength; }
+   uint32_t baud() const { return baudrate; }
+
+private:
+   const uint8_t *input;
+   size_t inputLength, inputPos;
+   uint8_t *output;
+   size_t outputCapacity, outputLength;
+   uint32_t baudrate;
+};
+
+#endif // def(__TinyGPSStream_h)
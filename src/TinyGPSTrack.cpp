@@ -0,0 +1,128 @@
+/*
+TinyGPSTrack - fixed-capacity track ring with online line simplification,
+fed from TinyGPS++ location commits.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSTrack.h"
+
+// Metres per 1e-7 degree of latitude
+#define _GPS_METERS_PER_E7 0.0111319
+
+TinyGPSTrack::TinyGPSTrack(TinyGPSTrackPoint *storage, size_t capacity, uint16_t toleranceMeters)
+  :  points(storage)
+  ,  cap(capacity)
+  ,  head(0)
+  ,  count(0)
+  ,  toleranceE7((uint32_t)(toleranceMeters / _GPS_METERS_PER_E7))
+  ,  cosLatQ15(1 << 15)
+  ,  pending(false)
+  ,  windowCount(0)
+{
+}
+
+int32_t TinyGPSTrack::toE7(const RawDegrees &deg)
+{
+   const int32_t e7 = (int32_t)deg.deg * 10000000L + (int32_t)((deg.billionths + 50) / 100);
+   return deg.negative ? -e7 : e7;
+}
+
+void TinyGPSTrack::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   if (!(fields & (1u << TinyGPSSnapshot::LOCATION)))
+      return;
+   // RMC and GGA of the same epoch both commit the location; without a
+   // time (lazy decoding that leaves it out) the epochs cannot be told apart
+   if (gps.time.isValid() && count && tail().time == gps.time.time)
+      return;
+   add(toE7(gps.location.rawLatData), toE7(gps.location.rawLngData), gps.time.time);
+}
+
+void TinyGPSTrack::add(int32_t lat, int32_t lng, uint32_t time)
+{
+   const TinyGPSTrackPoint p = {lat, lng, time};
+
+   if (pending)
+   {
+      const TinyGPSTrackPoint last = tail();
+      bool keep = windowCount == _GPS_TRACK_WINDOW || !withinTolerance(anchor, p, last);
+      for (uint8_t i = 0; i < windowCount && !keep; ++i)
+         keep = !withinTolerance(anchor, p, window[i]);
+      if (!keep)
+      {
+         window[windowCount++] = last;
+         tail() = p;
+         return;
+      }
+      // The previous last point is retained and anchors the next segment
+      setAnchor(last);
+   }
+   else if (count == 0)
+      setAnchor(p);
+
+   pending = count > 0;
+   if (count == cap)
+   {
+      head = (head + 1) % cap;
+      --count;
+   }
+   points[(head + count) % cap] = p;
+   ++count;
+}
+
+void TinyGPSTrack::setAnchor(const TinyGPSTrackPoint &p)
+{
+   anchor = p;
+   windowCount = 0;
+   cosLatQ15 = (int32_t)(cos(p.lat * 1e-7 * PI / 180.0) * 32768.0);
+}
+
+void TinyGPSTrack::consume(size_t n)
+{
+   if (n > count)
+      n = count;
+   head = (head + n) % cap;
+   count -= n;
+   if (count == 0)
+      clear();
+}
+
+void TinyGPSTrack::clear()
+{
+   head = count = 0;
+   pending = false;
+   windowCount = 0;
+}
+
+// East of 'from', the short way round across the antimeridian
+int64_t TinyGPSTrack::lngDelta(int32_t from, int32_t to)
+{
+   const int64_t d = (int64_t)to - from;
+   return d > 1800000000LL ? d - 3600000000LL : d < -1800000000LL ? d + 3600000000LL : d;
+}
+
+// Distance of p from segment a-b, in a local projection scaled by cos(lat)
+bool TinyGPSTrack::withinTolerance(const TinyGPSTrackPoint &a, const TinyGPSTrackPoint &b, const TinyGPSTrackPoint &p) const
+{
+   const int64_t bx = (lngDelta(a.lng, b.lng) * cosLatQ15) >> 15;
+   const int64_t by = (int64_t)b.lat - a.lat;
+   const int64_t px = (lngDelta(a.lng, p.lng) * cosLatQ15) >> 15;
+   const int64_t py = (int64_t)p.lat - a.lat;
+   const double tol2 = (double)toleranceE7 * toleranceE7;
+
+   const int64_t dot = px * bx + py * by;
+   const int64_t len2 = bx * bx + by * by;
+   if (dot <= 0 || len2 == 0)
+      return (double)(px * px + py * py) <= tol2;
+   if (dot >= len2)
+   {
+      const int64_t dx = px - bx, dy = py - by;
+      return (double)(dx * dx + dy * dy) <= tol2;
+   }
+   const double cross = (double)(px * by - py * bx);
+   return cross * cross <= tol2 * (double)len2;
+}
@@ -0,0 +1,65 @@
+/*
+TinyGPSTrack - fixed-capacity track ring with online line simplification,
+fed from TinyGPS++ location commits.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSTrack_h
+#define __TinyGPSTrack_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_TRACK_WINDOW 16 // max points dropped between two retained ones
+
+// Coordinates in 1e-7 degrees, time as TinyGPSTime::value()
+struct TinyGPSTrackPoint
+{
+   int32_t lat;
+   int32_t lng;
+   uint32_t time;
+};
+
+// Opening-window simplification: the newest fix is always the last point;
+// the previous last point is dropped while it and every point dropped since
+// the last retained one stay within 'tolerance' metres of the segment from
+// the retained point to the newest fix. When the ring is full the oldest
+// point is overwritten.
+class TinyGPSTrack : public TinyGPSListener
+{
+public:
+   TinyGPSTrack(TinyGPSTrackPoint *storage, size_t capacity, uint16_t toleranceMeters);
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+   // Every call adds a point; onCommit() skips the second fix of an epoch
+   void add(int32_t lat, int32_t lng, uint32_t time);
+
+   size_t size() const { return count; }
+   size_t capacity() const { return cap; }
+   // Oldest first
+   const TinyGPSTrackPoint &operator[](size_t i) const { return points[(head + i) % cap]; }
+   // Drops the n oldest points, e.g. after uploading them
+   void consume(size_t n);
+   void clear();
+
+   static int32_t toE7(const RawDegrees &deg);
+
+private:
+   static int64_t lngDelta(int32_t from, int32_t to);
+   bool withinTolerance(const TinyGPSTrackPoint &a, const TinyGPSTrackPoint &b, const TinyGPSTrackPoint &p) const;
+   void setAnchor(const TinyGPSTrackPoint &p);
+   TinyGPSTrackPoint &tail() { return points[(head + count - 1) % cap]; }
+
+   TinyGPSTrackPoint *points;
+   size_t cap, head, count;
+   uint32_t toleranceE7;
+   int32_t cosLatQ15;  // cos(latitude) of the anchor, Q15
+   bool pending;       // last point may still be dropped
+   TinyGPSTrackPoint anchor;
+   TinyGPSTrackPoint window[_GPS_TRACK_WINDOW];
+   uint8_t windowCount;
+};
+
+#endif // def(__TinyGPSTrack_h)
@@ -0,0 +1,107 @@
+/*
+TinyGPSTrig - single-precision trig kernels for distanceBetween/courseTo
+on 32-bit MCUs without an FPU.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSTrig.h"
+
+#include <math.h>
+
+#define _GPS_TRIG_PI_2 1.57079632679f
+#define _GPS_TRIG_PI_6 0.52359877560f
+#define _GPS_TRIG_2_PI_INV 0.63661977236f
+#define _GPS_TRIG_TAN_PI_12 0.26794919243f
+#define _GPS_TRIG_SQRT3 1.73205080757f
+#define _GPS_TRIG_DEG_TO_RAD 0.01745329252f
+
+float TinyGPSTrig::sinCos(float x, bool wantCos)
+{
+   // x = k * pi/2 + r, |r| <= pi/4; split constant keeps r accurate
+   const float kf = x * _GPS_TRIG_2_PI_INV;
+   const long k = (long)(kf < 0 ? kf - 0.5f : kf + 0.5f);
+   const float r = (x - k * 1.5703125f) - k * 4.83826794897e-4f;
+   const float r2 = r * r;
+   const float s = r * (1.0f + r2 * (-1.0f / 6 + r2 * (1.0f / 120 + r2 * (-1.0f / 5040 + r2 * (1.0f / 362880)))));
+   const float c = 1.0f + r2 * (-0.5f + r2 * (1.0f / 24 + r2 * (-1.0f / 720 + r2 * (1.0f / 40320))));
+   switch ((k + (wantCos ? 1 : 0)) & 3)
+   {
+   case 0: return s;
+   case 1: return c;
+   case 2: return -s;
+   default: return -c;
+   }
+}
+
+float TinyGPSTrig::sin(float x)
+{
+   return sinCos(x, false);
+}
+
+float TinyGPSTrig::cos(float x)
+{
+   return sinCos(x, true);
+}
+
+float TinyGPSTrig::atan2(float y, float x)
+{
+   const float ay = y < 0 ? -y : y;
+   const float ax = x < 0 ? -x : x;
+   if (ax == 0 && ay == 0)
+      return 0.0f;
+   const bool swap = ay > ax;
+   float t = swap ? ax / ay : ay / ax; // 0..1
+   float offset = 0.0f;
+   if (t > _GPS_TRIG_TAN_PI_12)
+   {
+      // atan(t) = pi/6 + atan((t*sqrt3 - 1) / (t + sqrt3))
+      t = (t * _GPS_TRIG_SQRT3 - 1.0f) / (t + _GPS_TRIG_SQRT3);
+      offset = _GPS_TRIG_PI_6;
+   }
+   const float t2 = t * t;
+   float a = offset + t * (1.0f + t2 * (-1.0f / 3 + t2 * (1.0f / 5 + t2 * (-1.0f / 7 + t2 * (1.0f / 9)))));
+   if (swap)
+      a = _GPS_TRIG_PI_2 - a;
+   if (x < 0)
+      a = 2 * _GPS_TRIG_PI_2 - a;
+   return y < 0 ? -a : a;
+}
+
+float TinyGPSTrig::distanceBetween(float lat1, float long1, float lat2, float long2)
+{
+   // Same formula as TinyGPSPlus::distanceBetween()
+   float delta = (long1 - long2) * _GPS_TRIG_DEG_TO_RAD;
+   const float sdlong = sin(delta);
+   const float cdlong = cos(delta);
+   lat1 *= _GPS_TRIG_DEG_TO_RAD;
+   lat2 *= _GPS_TRIG_DEG_TO_RAD;
+   const float slat1 = sin(lat1);
+   const float clat1 = cos(lat1);
+   const float slat2 = sin(lat2);
+   const float clat2 = cos(lat2);
+   delta = (clat1 * slat2) - (slat1 * clat2 * cdlong);
+   delta = delta * delta;
+   delta += (clat2 * sdlong) * (clat2 * sdlong);
+   delta = sqrtf(delta);
+   const float denom = (slat1 * slat2) + (clat1 * clat2 * cdlong);
+   return atan2(delta, denom) * 6372795.0f;
+}
+
+float TinyGPSTrig::courseTo(float lat1, float long1, float lat2, float long2)
+{
+   const float dlon = (long2 - long1) * _GPS_TRIG_DEG_TO_RAD;
+   lat1 *= _GPS_TRIG_DEG_TO_RAD;
+   lat2 *= _GPS_TRIG_DEG_TO_RAD;
+   const float clat2 = cos(lat2);
+   const float a1 = sin(dlon) * clat2;
+   float a2 = sin(lat1) * clat2 * cos(dlon);
+   a2 = cos(lat1) * sin(lat2) - a2;
+   a2 = atan2(a1, a2);
+   if (a2 < 0.0f)
+      a2 += 4 * _GPS_TRIG_PI_2;
+   return a2 / _GPS_TRIG_DEG_TO_RAD;
+}
@@ -0,0 +1,44 @@
+/*
+TinyGPSTrig - single-precision trig kernels for distanceBetween/courseTo
+on 32-bit MCUs without an FPU.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSTrig_h
+#define __TinyGPSTrig_h
+
+// Build with -D_GPS_FAST_TRIG to make TinyGPSPlus::distanceBetween() and
+// courseTo() use these instead of libm double sin/cos/atan2. This pays
+// where double is 64-bit soft-float (Cortex-M0/M3, ESP8266); on AVR,
+// where double is float, libm is already single precision and there is
+// nothing to gain.
+//
+// sin/cos: reduction to [-pi/4, pi/4] and short polynomials (degree 9/8).
+// atan2: reduction to |x| <= tan(pi/12) and a degree 9 polynomial.
+// Measured against libm double on the host (TestTinyGpsTrig):
+//   sin, cos        <= 3e-7 absolute
+//   atan2           <= 4e-7 rad
+//   distanceBetween <= 2.5 m + 2e-6 of the distance, for the same inputs
+//   courseTo        <= 0.01 deg for points more than 1 km apart
+// Most of the distance error is single-precision arithmetic in the
+// formula, which cancels at short range: with libm sinf/cosf/atan2f it
+// is still up to 1.8 m. Rounding double inputs to float adds up to 0.5 m.
+class TinyGPSTrig
+{
+public:
+   static float sin(float x);
+   static float cos(float x);
+   static float atan2(float y, float x);
+
+   static float distanceBetween(float lat1, float long1, float lat2, float long2);
+   static float courseTo(float lat1, float long1, float lat2, float long2);
+
+private:
+   static float sinCos(float x, bool wantCos);
+};
+
+#endif // def(__TinyGPSTrig_h)
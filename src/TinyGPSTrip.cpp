@@ -0,0 +1,121 @@
+/*
+TinyGPSTrip - incremental odometer and trip statistics fed from TinyGPS++
+location commits.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSTrip.h"
+
+#define _GPS_EARTH_RADIUS 6372795.0 // same sphere as distanceBetween()
+#define _GPS_CENTISECONDS_PER_DAY 8640000UL
+
+TinyGPSTrip::TinyGPSTrip()
+{
+   reset();
+}
+
+void TinyGPSTrip::reset()
+{
+   started = false;
+   refLat = refLng = 0.0;
+   refTimeCs = 0;
+   cosLat = 1.0;
+   cosLatAt = 1000.0;
+   lastTimeCs = 0;
+   lastSpeed = -1;
+   lastHdop = 0;
+   distance = 0.0;
+   elapsedCs = movingCs = 0;
+   maxSpeed = 0;
+   rejected = 0;
+}
+
+void TinyGPSTrip::onCommit(const TinyGPSPlus &gps, uint16_t fields)
+{
+   if (fields & (1u << TinyGPSSnapshot::SPEED))
+      lastSpeed = gps.speed.in(2);
+   if (fields & (1u << TinyGPSSnapshot::HDOP))
+      lastHdop = gps.hdop.in(2);
+   if (!(fields & (1u << TinyGPSSnapshot::LOCATION)))
+      return;
+
+   const RawDegrees &rawLat = gps.location.rawLatData;
+   const RawDegrees &rawLng = gps.location.rawLngData;
+   double lat = rawLat.deg + rawLat.billionths / 1000000000.0;
+   double lng = rawLng.deg + rawLng.billionths / 1000000000.0;
+   add(rawLat.negative ? -lat : lat, rawLng.negative ? -lng : lng, gps.time.time, lastSpeed, lastHdop);
+}
+
+void TinyGPSTrip::add(double lat, double lng, uint32_t time, int32_t speed, int32_t hdop)
+{
+   const uint32_t timeCs = centisecondsOfDay(time);
+   if (speed > maxSpeed)
+      maxSpeed = speed;
+   if (!started)
+   {
+      started = true;
+      refLat = lat;
+      refLng = lng;
+      refTimeCs = lastTimeCs = timeCs;
+      return;
+   }
+   // RMC and GGA of the same epoch both commit the location
+   if (timeCs == lastTimeCs)
+      return;
+
+   const uint32_t dt = (timeCs + _GPS_CENTISECONDS_PER_DAY - lastTimeCs) % _GPS_CENTISECONDS_PER_DAY;
+   lastTimeCs = timeCs;
+   elapsedCs += dt;
+
+   if (fabs(lat - cosLatAt) > 0.1)
+   {
+      cosLat = cos(radians(lat));
+      cosLatAt = lat;
+   }
+   double dLng = lng - refLng;
+   if (dLng > 180.0)
+      dLng -= 360.0;
+   else if (dLng < -180.0)
+      dLng += 360.0;
+   const double x = radians(dLng) * cosLat;
+   const double y = radians(lat - refLat);
+   double hop = _GPS_EARTH_RADIUS * sqrt(x * x + y * y);
+   if (hop > _GPS_TRIP_EXACT_METERS)
+      hop = TinyGPSPlus::distanceBetween(refLat, refLng, lat, lng);
+
+   const double jitter = _GPS_TRIP_JITTER_METERS_PER_HDOP * hdop / 100.0;
+   if (speed < 0)
+   {
+      const uint32_t sinceCs = (timeCs + _GPS_CENTISECONDS_PER_DAY - refTimeCs) % _GPS_CENTISECONDS_PER_DAY;
+      speed = hop < jitter ? 0 : (int32_t)(hop / sinceCs * 100.0 / _GPS_MPS_PER_KNOT * 100.0 + 0.5);
+      if (speed > maxSpeed)
+         maxSpeed = speed;
+   }
+   const bool moving = speed >= _GPS_TRIP_STATIONARY_SPEED;
+   if (moving)
+      movingCs += dt;
+
+   if (!moving && hop < jitter)
+   {
+      rejected++;
+      return;
+   }
+   distance += hop;
+   refLat = lat;
+   refLng = lng;
+   refTimeCs = timeCs;
+}
+
+double TinyGPSTrip::averageMovingKmph() const
+{
+   return movingCs ? distance / movingCs * 100.0 * 3.6 : 0.0;
+}
+
+uint32_t TinyGPSTrip::centisecondsOfDay(uint32_t time)
+{
+   return (time / 1000000) * 360000UL + ((time / 10000) % 100) * 6000UL + (time % 10000);
+}
@@ -0,0 +1,60 @@
+/*
+TinyGPSTrip - incremental odometer and trip statistics fed from TinyGPS++
+location commits.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSTrip_h
+#define __TinyGPSTrip_h
+
+#include "TinyGPS++.h"
+
+#define _GPS_TRIP_EXACT_METERS 2000.0      // longer hops use distanceBetween()
+#define _GPS_TRIP_STATIONARY_SPEED 50      // knots/100; below this counts as stopped
+#define _GPS_TRIP_JITTER_METERS_PER_HDOP 5.0
+
+// Hops below _GPS_TRIP_EXACT_METERS use an equirectangular estimate with
+// a cached cos(latitude), which is refreshed only when the latitude has
+// moved by more than ~0.1 degrees. While stopped, hops shorter than
+// hdop * _GPS_TRIP_JITTER_METERS_PER_HDOP are treated as jitter: the
+// reference point is kept, so slow real movement still adds up.
+// Without a reported speed (GGA-only output), the speed is the
+// displacement from the reference point over the time since it was set,
+// and zero for hops within the jitter.
+class TinyGPSTrip : public TinyGPSListener
+{
+public:
+   TinyGPSTrip();
+   void onCommit(const TinyGPSPlus &gps, uint16_t fields) override;
+   // time as TinyGPSTime::value(), speed in knots/100 or -1 if unknown,
+   // hdop in 1/100
+   void add(double lat, double lng, uint32_t time, int32_t speed, int32_t hdop);
+   void reset();
+
+   double distanceMeters() const { return distance; }
+   uint32_t elapsedSeconds() const { return elapsedCs / 100; }
+   uint32_t movingSeconds() const { return movingCs / 100; }
+   double maxSpeedKmph() const { return _GPS_KMPH_PER_KNOT * maxSpeed / 100.0; }
+   double averageMovingKmph() const;
+   uint32_t rejectedHops() const { return rejected; }
+
+private:
+   static uint32_t centisecondsOfDay(uint32_t time);
+
+   bool started;
+   double refLat, refLng;   // last accepted position
+   uint32_t refTimeCs;
+   double cosLat, cosLatAt;
+   uint32_t lastTimeCs;
+   int32_t lastSpeed, lastHdop; // lastSpeed -1 until one is committed
+   double distance;
+   uint32_t elapsedCs, movingCs;
+   int32_t maxSpeed;
+   uint32_t rejected;
+};
+
+#endif // def(__TinyGPSTrip_h)
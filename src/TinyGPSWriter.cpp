@@ -0,0 +1,343 @@
+/*
+TinyGPSWriter - allocation-free NMEA/JSON/CSV output of parsed TinyGPS++
+fields into a caller-provided buffer.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "TinyGPSWriter.h"
+
+// Two digits per lookup halves the divisions of a naive loop
+static const char digitPairs[] =
+   "00010203040506070809"
+   "10111213141516171819"
+   "20212223242526272829"
+   "30313233343536373839"
+   "40414243444546474849"
+   "50515253545556575859"
+   "60616263646566676869"
+   "70717273747576777879"
+   "80818283848586878889"
+   "90919293949596979899";
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+TinyGPSWriter::TinyGPSWriter(char *_buf, size_t _capacity)
+  :  buf(_buf)
+  ,  capacity(_capacity)
+  ,  len(0)
+  ,  sentenceStart(0)
+  ,  overflow(false)
+{
+   clear();
+}
+
+void TinyGPSWriter::clear()
+{
+   len = 0;
+   overflow = capacity == 0;
+   if (capacity)
+      buf[0] = '\0';
+}
+
+void TinyGPSWriter::put(char c)
+{
+   if (len + 1 < capacity)
+   {
+      buf[len++] = c;
+      buf[len] = '\0';
+   }
+   else
+      overflow = true;
+}
+
+void TinyGPSWriter::put(const char *s)
+{
+   while (*s)
+      put(*s++);
+}
+
+void TinyGPSWriter::unsignedInt(uint32_t value, uint8_t minDigits)
+{
+   char tmp[10];
+   uint8_t n = 0;
+   while (value >= 100)
+   {
+      const uint32_t pair = (value % 100) * 2;
+      value /= 100;
+      tmp[n++] = digitPairs[pair + 1];
+      tmp[n++] = digitPairs[pair];
+   }
+   if (value >= 10)
+   {
+      tmp[n++] = digitPairs[value * 2 + 1];
+      tmp[n++] = digitPairs[value * 2];
+   }
+   else
+      tmp[n++] = '0' + value;
+   while (n < minDigits && n < sizeof(tmp))
+      tmp[n++] = '0';
+   while (n)
+      put(tmp[--n]);
+}
+
+void TinyGPSWriter::fixed(int32_t value, uint8_t decimals)
+{
+   uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+   if (value < 0)
+      put('-');
+   uint32_t scale = 1;
+   for (uint8_t i = 0; i < decimals; ++i)
+      scale *= 10;
+   unsignedInt(magnitude / scale);
+   if (decimals)
+   {
+      put('.');
+      unsignedInt(magnitude % scale, decimals);
+   }
+}
+
+void TinyGPSWriter::decimalDegrees(const RawDegrees &deg)
+{
+   if (deg.negative)
+      put('-');
+   unsignedInt(deg.deg);
+   put('.');
+   unsignedInt(deg.billionths, 9);
+}
+
+void TinyGPSWriter::nmeaDegrees(const RawDegrees &deg, uint8_t degDigits)
+{
+   // Inverse of parseDegrees(): billionths = (5 * tenMillionthsOfMinutes + 1) / 3
+   const uint32_t tenMillionthsOfMinutes = (3 * deg.billionths + 2) / 5;
+   unsignedInt(deg.deg, degDigits);
+   unsignedInt(tenMillionthsOfMinutes / 10000000UL, 2);
+   put('.');
+   unsignedInt((tenMillionthsOfMinutes % 10000000UL) / 100, 5);
+}
+
+void TinyGPSWriter::nmeaTime(const TinyGPSTime &time)
+{
+   unsignedInt(time.time / 100, 6);
+   put('.');
+   unsignedInt(time.time % 100, 2);
+}
+
+void TinyGPSWriter::nmeaDate(const TinyGPSDate &date)
+{
+   unsignedInt(date.date, 6);
+}
+
+void TinyGPSWriter::isoTimestamp(const TinyGPSDate &date, const TinyGPSTime &time)
+{
+   unsignedInt(2000 + date.date % 100, 4);
+   put('-');
+   unsignedInt((date.date / 100) % 100, 2);
+   put('-');
+   unsignedInt(date.date / 10000, 2);
+   put('T');
+   unsignedInt(time.time / 1000000, 2);
+   put(':');
+   unsignedInt((time.time / 10000) % 100, 2);
+   put(':');
+   unsignedInt((time.time / 100) % 100, 2);
+   put('.');
+   unsignedInt(time.time % 100, 2);
+   put('Z');
+}
+
+void TinyGPSWriter::beginSentence()
+{
+   sentenceStart = len;
+   put('$');
+}
+
+bool TinyGPSWriter::endSentence()
+{
+   uint8_t parity = 0;
+   for (size_t i = sentenceStart + 1; i < len; ++i)
+      parity ^= (uint8_t)buf[i];
+   put('*');
+   put(hexDigits[parity >> 4]);
+   put(hexDigits[parity & 0xF]);
+   put("\r\n");
+   return !overflow;
+}
+
+bool TinyGPSWriter::rmc(const TinyGPSPlus &gps)
+{
+   const TinyGPSLocation &location = gps.location;
+   beginSentence();
+   put("GPRMC,");
+   if (gps.time.isValid())
+      nmeaTime(gps.time);
+   put(location.isValid() ? ",A," : ",V,");
+   if (location.isValid())
+   {
+      nmeaDegrees(location.rawLatData, 2);
+      put(location.rawLatData.negative ? ",S," : ",N,");
+      nmeaDegrees(location.rawLngData, 3);
+      put(location.rawLngData.negative ? ",W," : ",E,");
+   }
+   else
+      put(",,,,");
+   if (gps.speed.isValid())
+      fixed(gps.speed.val, TinyGPSSpeed::decimals);
+   put(',');
+   if (gps.course.isValid())
+      fixed(gps.course.val, TinyGPSCourse::decimals);
+   put(',');
+   if (gps.date.isValid())
+      nmeaDate(gps.date);
+   put(location.isValid() ? ",,,A" : ",,,N");
+   return endSentence();
+}
+
+bool TinyGPSWriter::gga(const TinyGPSPlus &gps)
+{
+   const TinyGPSLocation &location = gps.location;
+   beginSentence();
+   put("GPGGA,");
+   if (gps.time.isValid())
+      nmeaTime(gps.time);
+   put(',');
+   if (location.isValid())
+   {
+      nmeaDegrees(location.rawLatData, 2);
+      put(location.rawLatData.negative ? ",S," : ",N,");
+      nmeaDegrees(location.rawLngData, 3);
+      put(location.rawLngData.negative ? ",W," : ",E,");
+   }
+   else
+      put(",,,,");
+   put(gps.ggaFix ? '1' : '0');
+   put(',');
+   if (gps.satellites.isValid())
+      unsignedInt(gps.satellites.val, 2);
+   put(',');
+   if (gps.hdop.isValid())
+      fixed(gps.hdop.val, TinyGPSHDOP::decimals);
+   put(',');
+   if (gps.altitude.isValid())
+      fixed(gps.altitude.in(1), 1);
+   put(",M,,M,,");
+   return endSentence();
+}
+
+bool TinyGPSWriter::gsa(const Gsa &gsa)
+{
+   beginSentence();
+   put("GPGSA,");
+   if (gsa.mode() != 'N')
+      put(gsa.mode());
+   put(',');
+   const char *fix = gsa.fix();
+   put(fix[0] == '2' ? '2' : fix[0] == '3' ? '3' : '1');
+   for (int i = 0; i < 12; ++i)
+   {
+      put(',');
+      if (i < gsa.numSats())
+         unsignedInt(gsa.sats()[i], 2);
+   }
+   put(',');
+   fixed(gsa.rawPdop(), Gsa::Fixed::decimals);
+   put(',');
+   fixed(gsa.rawHdop(), Gsa::Fixed::decimals);
+   put(',');
+   fixed(gsa.rawVdop(), Gsa::Fixed::decimals);
+   return endSentence();
+}
+
+bool TinyGPSWriter::gsv(const SatsInView &sats)
+{
+   const unsigned int count = sats.numOfDb();
+   const unsigned int messages = count ? (count + 3) / 4 : 1;
+   for (unsigned int msg = 0; msg < messages; ++msg)
+   {
+      beginSentence();
+      put("GPGSV,");
+      unsignedInt(messages);
+      put(',');
+      unsignedInt(msg + 1);
+      put(',');
+      unsignedInt(sats.numOf(), 2);
+      for (unsigned int i = msg * 4; i < count && i < msg * 4 + 4; ++i)
+      {
+         put(',');
+         unsignedInt(sats[i].id(), 2);
+         put(",,,");
+         put(sats[i].snr().c_str());
+      }
+      if (!endSentence())
+         return false;
+   }
+   return true;
+}
+
+bool TinyGPSWriter::json(const TinyGPSPlus &gps)
+{
+   put("{\"time\":");
+   if (gps.date.isValid() && gps.time.isValid())
+   {
+      put('"');
+      isoTimestamp(gps.date, gps.time);
+      put('"');
+   }
+   else
+      put("null");
+   put(",\"lat\":");
+   if (gps.location.isValid())
+   {
+      decimalDegrees(gps.location.rawLatData);
+      put(",\"lng\":");
+      decimalDegrees(gps.location.rawLngData);
+   }
+   else
+      put("null,\"lng\":null");
+   put(",\"speed\":");
+   if (gps.speed.isValid()) fixed(gps.speed.val, TinyGPSSpeed::decimals); else put("null");
+   put(",\"course\":");
+   if (gps.course.isValid()) fixed(gps.course.val, TinyGPSCourse::decimals); else put("null");
+   put(",\"alt\":");
+   if (gps.altitude.isValid()) fixed(gps.altitude.val, TinyGPSAltitude::decimals); else put("null");
+   put(",\"sats\":");
+   if (gps.satellites.isValid()) unsignedInt(gps.satellites.val); else put("null");
+   put(",\"hdop\":");
+   if (gps.hdop.isValid()) fixed(gps.hdop.val, TinyGPSHDOP::decimals); else put("null");
+   put(",\"fix\":\"");
+   put(gps.gsa.fix());
+   put("\"}\n");
+   return !overflow;
+}
+
+bool TinyGPSWriter::csv(const TinyGPSPlus &gps)
+{
+   if (gps.date.isValid() && gps.time.isValid())
+      isoTimestamp(gps.date, gps.time);
+   put(',');
+   if (gps.location.isValid())
+   {
+      decimalDegrees(gps.location.rawLatData);
+      put(',');
+      decimalDegrees(gps.location.rawLngData);
+   }
+   else
+      put(',');
+   put(',');
+   if (gps.speed.isValid()) fixed(gps.speed.val, TinyGPSSpeed::decimals);
+   put(',');
+   if (gps.course.isValid()) fixed(gps.course.val, TinyGPSCourse::decimals);
+   put(',');
+   if (gps.altitude.isValid()) fixed(gps.altitude.val, TinyGPSAltitude::decimals);
+   put(',');
+   if (gps.satellites.isValid()) unsignedInt(gps.satellites.val);
+   put(',');
+   if (gps.hdop.isValid()) fixed(gps.hdop.val, TinyGPSHDOP::decimals);
+   put(',');
+   put(gps.gsa.fix());
+   put('\n');
+   return !overflow;
+}
@@ -0,0 +1,61 @@
+/*
+TinyGPSWriter - allocation-free NMEA/JSON/CSV output of parsed TinyGPS++
+fields into a caller-provided buffer.
+
+This library is free software; you can redistribute it and/or
+modify it under the terms of the GNU Lesser General Public
+License as published by the Free Software Foundation; either
+version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef __TinyGPSWriter_h
+#define __TinyGPSWriter_h
+
+#include "TinyGPS++.h"
+
+// Appends records to buf; the content is always NUL terminated. Numbers
+// are formatted from the stored fixed-point values with integer
+// arithmetic only. On overflow the record is cut short, overflowed()
+// stays set until clear() and the record methods return false.
+class TinyGPSWriter
+{
+public:
+   TinyGPSWriter(char *buf, size_t capacity);
+   void clear();
+   const char *c_str() const { return buf; }
+   size_t length() const { return len; }
+   bool overflowed() const { return overflow; }
+
+   // NMEA sentences with recomputed checksum and CRLF
+   bool rmc(const TinyGPSPlus &gps);
+   bool gga(const TinyGPSPlus &gps);
+   bool gsa(const Gsa &gsa);
+   bool gsv(const SatsInView &sats); // the whole group
+
+   // One record per call; invalid fields are null/empty
+   bool json(const TinyGPSPlus &gps);
+   bool csv(const TinyGPSPlus &gps);
+
+   // Building blocks
+   void put(char c);
+   void put(const char *s);
+   void unsignedInt(uint32_t value, uint8_t minDigits = 1);
+   void fixed(int32_t value, uint8_t decimals);
+   void decimalDegrees(const RawDegrees &deg);                   // -65.076160833
+   void nmeaDegrees(const RawDegrees &deg, uint8_t degDigits); // 6504.56965,N
+   void nmeaTime(const TinyGPSTime &time);                  // hhmmss.cc
+   void nmeaDate(const TinyGPSDate &date);                  // ddmmyy
+   void isoTimestamp(const TinyGPSDate &date, const TinyGPSTime &time); // 2019-10-08T17:56:28.00Z
+   void beginSentence();  // '$'
+   bool endSentence();    // checksum and CRLF
+
+private:
+
+   char *buf;
+   size_t capacity;
+   size_t len;
+   size_t sentenceStart;
+   bool overflow;
+};
+
+#endif // def(__TinyGPSWriter_h)
@@ -0,0 +1,86 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPS++.h"
+#include <chrono>
+#include <iomanip>
+
+namespace
+{
+typedef TinyGPSPlus::DistanceModel Model;
+struct Case
+{
+    const char* name;
+    double lat1, lng1, lat2, lng2;
+};
+const Case cases[] = {
+    {"5 m",       65.0757, 25.4865, 65.07574, 25.4866},
+    {"500 m",     65.0757, 25.4865, 65.0800, 25.4800},
+    {"50 km",     60.1699, 24.9384, 60.4518, 22.2666},
+    {"500 km",    60.1699, 24.9384, 65.0121, 25.4651},
+    {"5000 km",   60.1699, 24.9384, 40.4168, -3.7038},
+    {"equator",   0.0, 0.0, 0.0, 45.0},
+};
+}
+
+class TestDistanceModels : public ::testing::Test
+{
+protected:
+    static double relativeError(const Case& c, Model model)
+    {
+        const double reference = TinyGPSPlus::distanceBetween(c.lat1, c.lng1, c.lat2, c.lng2, Model::ELLIPSOIDAL);
+        const double d = TinyGPSPlus::distanceBetween(c.lat1, c.lng1, c.lat2, c.lng2, model);
+        return fabs(d - reference) / reference;
+    }
+};
+TEST_F(TestDistanceModels, vincentyKnownDistances)
+{
+    // Flinders Peak to Buninyong, Vincenty (1975)
+    EXPECT_NEAR(54972.271, TinyGPSPlus::distanceBetween(-37.95103342, 144.42486789, -37.65282114, 143.92649554, Model::ELLIPSOIDAL), 1e-3);
+    // A quarter of the equator
+    EXPECT_NEAR(10018754.171, TinyGPSPlus::distanceBetween(0.0, 0.0, 0.0, 90.0, Model::ELLIPSOIDAL), 1e-3);
+    EXPECT_EQ(0.0, TinyGPSPlus::distanceBetween(65.0, 25.0, 65.0, 25.0, Model::ELLIPSOIDAL));
+}
+TEST_F(TestDistanceModels, sphericalIsDefault)
+{
+    for (const Case& c : cases)
+    {
+        EXPECT_EQ(TinyGPSPlus::distanceBetween(c.lat1, c.lng1, c.lat2, c.lng2),
+                  TinyGPSPlus::distanceBetween(c.lat1, c.lng1, c.lat2, c.lng2, Model::SPHERICAL));
+    }
+}
+TEST_F(TestDistanceModels, nearlyAntipodalFallsBackToSphere)
+{
+    const double d = TinyGPSPlus::distanceBetween(0.0, 0.0, 0.5, 179.7, Model::ELLIPSOIDAL);
+    EXPECT_NEAR(TinyGPSPlus::distanceBetween(0.0, 0.0, 0.5, 179.7), d, d * 0.005);
+}
+TEST_F(TestDistanceModels, errorTable)
+{
+    std::cout << "range       equirect.  spherical   (% error vs WGS-84)" << std::endl;
+    for (const Case& c : cases)
+    {
+        const double flat = relativeError(c, Model::EQUIRECTANGULAR);
+        const double sphere = relativeError(c, Model::SPHERICAL);
+        std::cout << std::left << std::setw(12) << c.name << std::fixed << std::setprecision(4)
+                  << std::setw(11) << flat * 100 << sphere * 100 << std::endl;
+        EXPECT_LT(sphere, 0.006);
+    }
+    EXPECT_LT(relativeError(cases[0], Model::EQUIRECTANGULAR), 0.006);
+    EXPECT_LT(relativeError(cases[1], Model::EQUIRECTANGULAR), 0.006);
+    EXPECT_LT(relativeError(cases[2], Model::EQUIRECTANGULAR), 0.006);
+}
+TEST_F(TestDistanceModels, benchmark)
+{
+    const int rounds = 20000;
+    for (Model model : {Model::EQUIRECTANGULAR, Model::SPHERICAL, Model::ELLIPSOIDAL})
+    {
+        volatile double sink = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+        {
+            const Case& c = cases[i % 6];
+            sink = sink + TinyGPSPlus::distanceBetween(c.lat1, c.lng1, c.lat2, c.lng2 + i * 1e-9, model);
+        }
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "model " << (int)model << ": " << ns / rounds << " ns/call" << std::endl;
+    }
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "TinyGPSAsync.h"
+
+// Built only as C++20; the ut target is C++11
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <vector>
+
+namespace
+{
+const std::string rmc{"$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n"};
+const std::string rmcNoFix{"$GPRMC,175404.00,V,,,,,,,081019,,,N*7F\n"};
+const std::string gga{"$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n"};
+const std::string gsv{"$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n"};
+
+TinyGPSTask countFixes(TinyGPSAsync& async, int& fixes, int until)
+{
+    while (fixes < until)
+    {
+        TinyGPSPlus& fix = co_await async.nextFix();
+        EXPECT_TRUE(fix.location.isUpdated());
+        EXPECT_NEAR(65.076161, fix.location.lat(), 1e-6);
+        ++fixes;
+    }
+}
+TinyGPSTask logSentences(TinyGPSAsync& async, std::vector<std::string>& log)
+{
+    for (;;)
+    {
+        TinyGPSPlus::EncodeStatus status = co_await async.nextSentence(TinyGPSPlus::EncodeStatus::GGA);
+        log.push_back(status == TinyGPSPlus::EncodeStatus::GGA ? "GGA" : "?");
+        const SatsInView& view = co_await async.nextSatelliteView();
+        log.push_back("GSV " + std::to_string(view.numOf()));
+    }
+}
+}
+
+class TestTinyGpsAsync : public ::testing::Test
+{
+protected:
+    void feed(const std::string& s)
+    {
+        async.feed(s.data(), s.size());
+    }
+    TinyGPSPlus gps;
+    TinyGPSAsync async{gps};
+};
+TEST_F(TestTinyGpsAsync, fixResumesOnlyOnFix)
+{
+    int fixes = 0;
+    countFixes(async, fixes, 2);
+    feed(rmcNoFix);
+    EXPECT_EQ(0, fixes);
+    feed(rmc + gga);
+    EXPECT_EQ(2, fixes);
+    feed(rmc);
+    EXPECT_EQ(2, fixes);
+}
+TEST_F(TestTinyGpsAsync, awaitsInSequence)
+{
+    std::vector<std::string> log;
+    logSentences(async, log);
+    feed(gsv + rmc + gga + rmc);
+    ASSERT_EQ(1u, log.size());
+    feed(gsv);
+    feed(gga.substr(0, 20));
+    ASSERT_EQ(2u, log.size());
+    EXPECT_EQ("GSV 4", log[1]);
+    feed(gga.substr(20));
+    EXPECT_EQ(3u, log.size());
+}
+TEST_F(TestTinyGpsAsync, parserOutlivesAsync)
+{
+    int fixes = 0;
+    {
+        TinyGPSAsync scoped{gps};
+        countFixes(scoped, fixes, 2);
+        scoped.feed(rmc.data(), rmc.size());
+        EXPECT_EQ(1, fixes);
+    }
+    // The parser goes on without calling into the destroyed driver
+    feed(rmc + gga);
+    EXPECT_EQ(1, fixes);
+    EXPECT_EQ(3u, gps.passedChecksum());
+}
+TEST_F(TestTinyGpsAsync, manyStreamsOnOneThreadReuseFrames)
+{
+    int fixes = 0;
+    const size_t before = TinyGPSFramePool::local().allocations();
+    {
+        std::vector<TinyGPSPlus> receivers(100);
+        std::vector<std::unique_ptr<TinyGPSAsync>> devices;
+        for (TinyGPSPlus& receiver : receivers)
+        {
+            devices.emplace_back(new TinyGPSAsync(receiver));
+            countFixes(*devices.back(), fixes, fixes + 1000);
+        }
+        for (auto& device : devices)
+        {
+            device->feed(rmc.data(), rmc.size());
+        }
+        EXPECT_EQ(100, fixes);
+        // devices destroyed with their coroutines still waiting
+    }
+    const size_t used = TinyGPSFramePool::local().allocations() - before;
+    EXPECT_LE(used, 100u);
+    for (int round = 0; round < 3; ++round)
+    {
+        std::vector<TinyGPSPlus> receivers(100);
+        std::vector<std::unique_ptr<TinyGPSAsync>> devices;
+        for (TinyGPSPlus& receiver : receivers)
+        {
+            devices.emplace_back(new TinyGPSAsync(receiver));
+            countFixes(*devices.back(), fixes, fixes + 1000);
+        }
+    }
+    EXPECT_EQ(used, TinyGPSFramePool::local().allocations() - before);
+}
+#endif
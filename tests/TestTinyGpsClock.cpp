@@ -0,0 +1,80 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSClock.h"
+#include <random>
+
+class TestTinyGpsClock : public ::testing::Test
+{
+protected:
+    // Local clock: starts at an arbitrary point and runs 'ppm' fast
+    uint32_t localAt(uint64_t utcUs) const
+    {
+        const double elapsed = (double)(utcUs - utcStart);
+        return localStart + (uint32_t)(int64_t)(elapsed * (1.0 + ppm * 1e-6));
+    }
+    void simulate(int seconds, uint32_t latencyUs, uint32_t jitterUs)
+    {
+        std::mt19937 rng{42};
+        std::uniform_int_distribution<uint32_t> jitter{0, jitterUs};
+        for (int i = 0; i < seconds; i++)
+        {
+            const uint64_t utc = utcStart + (uint64_t)i * 1000000;
+            clock.add(utc, localAt(utc + latencyUs + jitter(rng)));
+        }
+    }
+    int64_t errorAt(uint64_t utc) const
+    {
+        return (int64_t)(clock.utcUs(localAt(utc)) - utc);
+    }
+    const uint64_t utcStart{1608899131ULL * 1000000};
+    const uint32_t localStart{4000000000UL}; // wraps during the run
+    double ppm{0.0};
+    TinyGPSClock clock;
+};
+TEST_F(TestTinyGpsClock, notValidBeforeTwoSamples)
+{
+    EXPECT_FALSE(clock.isValid());
+    clock.add(utcStart, 1000);
+    EXPECT_FALSE(clock.isValid());
+    clock.add(utcStart + 1000000, 1001000);
+    EXPECT_TRUE(clock.isValid());
+}
+TEST_F(TestTinyGpsClock, tracksOffsetAndDriftThroughJitter)
+{
+    ppm = 50.0;
+    clock.setLatency(300000);
+    simulate(300, 300000, 80000);
+    const uint64_t last = utcStart + 299ULL * 1000000;
+    for (uint64_t t : {last + 400000, last + 700000, last + 990000})
+    {
+        EXPECT_LT(llabs(errorAt(t)), 5000) << t - last;
+    }
+    EXPECT_NEAR(50000, clock.driftPpb(), 5000);
+}
+TEST_F(TestTinyGpsClock, slowClockDrift)
+{
+    ppm = -50.0;
+    simulate(300, 0, 0);
+    EXPECT_NEAR(-50000, clock.driftPpb(), 5000);
+    EXPECT_LT(llabs(errorAt(utcStart + 299ULL * 1000000 + 500000)), 1000);
+}
+TEST_F(TestTinyGpsClock, stepRestartsFilter)
+{
+    simulate(20, 0, 0);
+    const uint64_t jumped = utcStart + 3600ULL * 1000000;
+    clock.add(jumped, localAt(utcStart + 20ULL * 1000000));
+    EXPECT_FALSE(clock.isValid());
+    EXPECT_EQ(jumped, clock.utcUs(localAt(utcStart + 20ULL * 1000000)));
+}
+TEST_F(TestTinyGpsClock, fedFromTimestampCommits)
+{
+    TinyGPSPlus gps;
+    gps.addListener(&clock);
+    const std::string s1{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    const std::string s2{"$GPGGA,122532.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*60\n"};
+    size_t consumed = 0;
+    gps.encodeGiveStatus(s1.data(), s1.size(), consumed, 5000);
+    gps.encodeGiveStatus(s2.data(), s2.size(), consumed, 6000);
+    ASSERT_TRUE(clock.isValid());
+    EXPECT_EQ(1608899132ULL * 1000000, clock.utcUs(gps.timestamp.arrival() * 1000));
+}
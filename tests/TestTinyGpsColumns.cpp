@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "TinyGPSColumns.h"
+#include <numeric>
+
+namespace
+{
+const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\r\n"};
+const std::string gga{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\r\n"};
+const std::string gsa{"$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\r\n"};
+}
+
+class TestTinyGpsColumns : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        gps.addListener(&exporter);
+    }
+    void encode(const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+    }
+    TinyGPSPlus gps;
+    TinyGPSColumns columns;
+    TinyGPSColumnExport exporter{columns};
+};
+TEST_F(TestTinyGpsColumns, sentencesOfOneEpochFillOneRow)
+{
+    encode(rmc);
+    encode(gga);
+    encode(gsa);
+    ASSERT_EQ(1u, columns.size());
+    EXPECT_EQ(1608899131000LL, columns.time[0]);
+    EXPECT_EQ(650757245, columns.lat[0]);
+    EXPECT_EQ(254865483, columns.lng[0]);
+    EXPECT_EQ(40, columns.speed[0]);
+    EXPECT_EQ(1580, columns.altitude[0]);
+    EXPECT_EQ(250, columns.hdop[0]);
+    EXPECT_EQ(345, columns.pdop[0]);
+    EXPECT_EQ(8, columns.sats[0]);
+    EXPECT_EQ(TinyGPSColumns::FIX_3D, columns.fix[0]);
+}
+TEST_F(TestTinyGpsColumns, newTimeStartsNewRow)
+{
+    encode(rmc);
+    encode("$GPRMC,122532.00,V,,,,,,,251220,,,N*7E\r\n");
+    ASSERT_EQ(2u, columns.size());
+    EXPECT_EQ(columns.time[0] + 1000, columns.time[1]);
+    EXPECT_EQ(TinyGPSColumns::FIX_UNKNOWN, columns.fix[0]);
+    EXPECT_EQ(TinyGPSColumns::FIX_NONE, columns.fix[1]);
+}
+TEST_F(TestTinyGpsColumns, ggaOnlyRowsTimedByTimeOfDay)
+{
+    encode(gga);
+    encode(gsa);
+    encode("$GPGGA,122532.00,6504.54347,N,02529.19290,E,1,07,2.60,15.9,M,21.0,M,,*6D\r\n");
+    ASSERT_EQ(2u, columns.size());
+    EXPECT_EQ((12 * 3600 + 25 * 60 + 31) * 1000LL, columns.time[0]);
+    EXPECT_EQ(columns.time[0] + 1000, columns.time[1]);
+    EXPECT_EQ(650757245, columns.lat[0]);
+    EXPECT_EQ(TinyGPSColumns::FIX_3D, columns.fix[0]);
+    EXPECT_EQ(7, columns.sats[1]);
+}
+TEST_F(TestTinyGpsColumns, blocksRoundTripThroughFile)
+{
+    FILE* file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    TinyGPSColumns staged;
+    TinyGPSColumnExport toFile{staged, file, 1};
+    gps.addListener(&toFile);
+    encode(rmc);
+    encode("$GPRMC,122532.00,V,,,,,,,251220,,,N*7E\r\n");
+    EXPECT_EQ(1u, staged.size());
+    EXPECT_TRUE(toFile.flush());
+    EXPECT_EQ(0u, staged.size());
+
+    rewind(file);
+    TinyGPSColumns loaded;
+    EXPECT_TRUE(loaded.read(file));
+    EXPECT_TRUE(loaded.read(file));
+    EXPECT_FALSE(loaded.read(file));
+    fclose(file);
+    ASSERT_EQ(columns.size(), loaded.size());
+    EXPECT_EQ(columns.time, loaded.time);
+    EXPECT_EQ(columns.lat, loaded.lat);
+    EXPECT_EQ(columns.speed, loaded.speed);
+    EXPECT_EQ(columns.fix, loaded.fix);
+}
+TEST(TestTinyGpsAggregate, availabilityAndMean)
+{
+    const uint8_t fix[]{0, 1, 2, 3, 3, 3, 2, 0};
+    EXPECT_EQ(6u, TinyGPSAggregate::countAtLeast(fix, sizeof(fix), TinyGPSColumns::FIX_UNKNOWN));
+    EXPECT_EQ(3u, TinyGPSAggregate::countAtLeast(fix, sizeof(fix), TinyGPSColumns::FIX_3D));
+    const uint16_t speed[]{100, 200, 300, 400};
+    EXPECT_EQ(1000u, TinyGPSAggregate::sum(speed, 4));
+}
+TEST(TestTinyGpsAggregate, histogramsAndPercentile)
+{
+    std::vector<uint16_t> hdop;
+    for (uint16_t i = 0; i < 1000; ++i)
+    {
+        hdop.push_back(i);
+    }
+    uint32_t bins[10]{};
+    TinyGPSAggregate::histogram(hdop.data(), hdop.size(), 50, bins, 10);
+    EXPECT_EQ(50u, bins[0]);
+    EXPECT_EQ(550u, bins[9]);
+    EXPECT_EQ(100u, TinyGPSAggregate::percentile(bins, 10, 50, 10));
+    EXPECT_EQ(450u, TinyGPSAggregate::percentile(bins, 10, 50, 45));
+
+    uint32_t parallel[10]{};
+    TinyGPSAggregate::parallelHistogram(hdop.data(), hdop.size(), 50, parallel, 10, 3);
+    EXPECT_TRUE(std::equal(bins, bins + 10, parallel));
+
+    // Chunks that do not divide evenly
+    const uint16_t few[]{0, 60, 120, 180, 240};
+    uint32_t fewBins[10]{};
+    TinyGPSAggregate::parallelHistogram(few, 5, 50, fewBins, 10, 4);
+    EXPECT_EQ(1u, fewBins[0]);
+    EXPECT_EQ(1u, fewBins[1]);
+    EXPECT_EQ(1u, fewBins[4]);
+    EXPECT_EQ(5u, std::accumulate(fewBins, fewBins + 10, 0u));
+
+    const uint8_t sats[]{4, 4, 4, 4, 5, 12, 30};
+    uint32_t satBins[13]{};
+    TinyGPSAggregate::histogram(sats, sizeof(sats), satBins, 13);
+    EXPECT_EQ(4u, satBins[4]);
+    EXPECT_EQ(1u, satBins[5]);
+    EXPECT_EQ(2u, satBins[12]);
+}
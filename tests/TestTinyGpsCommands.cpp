@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+#include "TinyGPSCommands.h"
+
+namespace
+{
+const uint8_t rate100ms[] = {0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00, 0x7A, 0x12};
+const uint8_t ackRate[] = {0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x08, 0x16, 0x3F};
+const uint8_t nakRate[] = {0xB5, 0x62, 0x05, 0x00, 0x02, 0x00, 0x06, 0x08, 0x15, 0x3A};
+const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\r\n"};
+const std::string gga{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\r\n"};
+
+struct CallbackLog
+{
+    uint16_t ticket{};
+    bool ok{};
+    int calls{};
+};
+void logCallback(uint16_t ticket, bool ok, void *context)
+{
+    CallbackLog *log = static_cast<CallbackLog*>(context);
+    log->ticket = ticket;
+    log->ok = ok;
+    log->calls++;
+}
+}
+
+class TestTinyGpsCommands : public ::testing::Test
+{
+protected:
+    void encode(const uint8_t *bytes, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            gps.encode((char)bytes[i]);
+        }
+    }
+    std::string written() const
+    {
+        return std::string((const char*)out, stream.written());
+    }
+    uint8_t out[512]{};
+    TinyGPSMemoryStream stream{nullptr, 0, out, sizeof(out)};
+    TinyGPSPlus gps{stream};
+    TinyGPSCommands commands{gps, 9600};
+};
+TEST_F(TestTinyGpsCommands, ackCompletesUbxCommand)
+{
+    CallbackLog log;
+    const uint16_t ticket = commands.ubx(rate100ms, sizeof(rate100ms), logCallback, &log);
+    ASSERT_NE(0, ticket);
+    EXPECT_EQ(TinyGPSCommands::Status::QUEUED, commands.status(ticket));
+    commands.poll();
+    EXPECT_EQ(TinyGPSCommands::Status::SENT, commands.status(ticket));
+    EXPECT_EQ(sizeof(rate100ms) + 2, stream.written());
+    encode(ackRate, sizeof(ackRate));
+    EXPECT_EQ(TinyGPSCommands::Status::DONE, commands.status(ticket));
+    EXPECT_TRUE(commands.idle());
+    EXPECT_EQ(1, log.calls);
+    EXPECT_EQ(ticket, log.ticket);
+    EXPECT_TRUE(log.ok);
+}
+TEST_F(TestTinyGpsCommands, nakFailsWithoutRetry)
+{
+    CallbackLog log;
+    const uint16_t ticket = commands.ubx(rate100ms, sizeof(rate100ms), logCallback, &log);
+    commands.poll();
+    encode(nakRate, sizeof(nakRate));
+    EXPECT_EQ(TinyGPSCommands::Status::FAILED, commands.status(ticket));
+    EXPECT_FALSE(log.ok);
+    EXPECT_EQ(sizeof(rate100ms) + 2, stream.written());
+}
+TEST_F(TestTinyGpsCommands, timeoutRetriesThenFails)
+{
+    const uint16_t ticket = commands.ubx(rate100ms, sizeof(rate100ms));
+    for (int i = 0; i < 10; i++)
+    {
+        commands.poll();
+        delay(_GPS_CMD_TIMEOUT_MS + 20);
+    }
+    EXPECT_EQ(TinyGPSCommands::Status::FAILED, commands.status(ticket));
+    EXPECT_EQ((1 + _GPS_CMD_RETRIES) * (sizeof(rate100ms) + 2), stream.written());
+}
+TEST_F(TestTinyGpsCommands, ackFoundBetweenSentences)
+{
+    std::string input{rmc};
+    input.append((const char*)ackRate, sizeof(ackRate));
+    input.append(gga);
+    TinyGPSMemoryStream rx{(const uint8_t*)input.data(), input.size(), out, sizeof(out)};
+    TinyGPSPlus receiver{rx};
+    TinyGPSCommands queue{receiver, 9600};
+    const uint16_t ticket = queue.ubx(rate100ms, sizeof(rate100ms));
+    queue.poll();
+    EXPECT_TRUE(receiver.readSerial());
+    EXPECT_EQ(2, receiver.passedChecksum());
+    EXPECT_EQ(TinyGPSCommands::Status::DONE, queue.status(ticket));
+}
+TEST_F(TestTinyGpsCommands, baudChangeWaitsForUart)
+{
+    stream.setBaudrate(9600);
+    const uint16_t pubx = commands.pubx("$PUBX,40,GSV,0,0,0,0,0,0*59");
+    const uint16_t baud = commands.baudrate(115200);
+    commands.poll();
+    EXPECT_EQ(TinyGPSCommands::Status::SENT, commands.status(pubx));
+    delay(31); // 30 bytes at 9600 baud
+    commands.poll();
+    EXPECT_EQ(TinyGPSCommands::Status::DONE, commands.status(pubx));
+    EXPECT_EQ(TinyGPSCommands::Status::SENT, commands.status(baud));
+    EXPECT_EQ("$PUBX,40,GSV,0,0,0,0,0,0*59\r\n$PUBX,41,1,0007,0003,115200,0*18\r\n", written());
+    delay(30);
+    commands.poll();
+    EXPECT_EQ(9600, stream.baud());
+    delay(10);
+    commands.poll();
+    EXPECT_EQ(TinyGPSCommands::Status::DONE, commands.status(baud));
+    EXPECT_EQ(115200, stream.baud());
+    EXPECT_EQ(115200, commands.baud());
+}
+TEST_F(TestTinyGpsCommands, fullQueueRefused)
+{
+    for (int i = 0; i < _GPS_CMD_QUEUE_SIZE; i++)
+    {
+        EXPECT_NE(0, commands.ubx(rate100ms, sizeof(rate100ms)));
+    }
+    EXPECT_EQ(0, commands.ubx(rate100ms, sizeof(rate100ms)));
+    EXPECT_EQ(TinyGPSCommands::Status::UNKNOWN, commands.status(0));
+}
+TEST_F(TestTinyGpsCommands, parserOutlivesQueue)
+{
+    CallbackLog log;
+    {
+        TinyGPSCommands scoped{gps, 9600};
+        scoped.ubx(rate100ms, sizeof(rate100ms), logCallback, &log);
+        scoped.poll();
+    }
+    // The late ACK reaches only the queue still attached
+    encode(ackRate, sizeof(ackRate));
+    EXPECT_EQ(0, log.calls);
+}
+TEST_F(TestTinyGpsCommands, zeroBaudRejected)
+{
+    TinyGPSCommands unknown{gps, 0};
+    EXPECT_EQ(9600, unknown.baud());
+    EXPECT_EQ(0, unknown.baudrate(0));
+    EXPECT_TRUE(unknown.idle());
+}
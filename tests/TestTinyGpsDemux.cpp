@@ -0,0 +1,278 @@
+#include "gtest/gtest.h"
+#include "TinyGPSDemux.h"
+#include <vector>
+
+namespace
+{
+typedef std::vector<uint8_t> Bytes;
+
+const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\r\n"};
+const std::string gga{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\r\n"};
+const uint8_t ackRate[] = {0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x08, 0x16, 0x3F};
+
+Bytes ubx(uint8_t msgClass, uint8_t msgId, const Bytes& payload)
+{
+    Bytes frame{0xB5, 0x62, msgClass, msgId, (uint8_t)payload.size(), (uint8_t)(payload.size() >> 8)};
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    const uint16_t ck = TinyGPSDemux::fletcher8(frame.data() + 2, frame.size() - 2);
+    frame.push_back(ck & 0xFF);
+    frame.push_back(ck >> 8);
+    return frame;
+}
+
+Bytes rtcm(uint16_t messageNumber, size_t length)
+{
+    Bytes frame{0xD3, (uint8_t)(length >> 8), (uint8_t)length, (uint8_t)(messageNumber >> 4), (uint8_t)(messageNumber << 4)};
+    for (size_t i = 2; i < length; ++i)
+    {
+        frame.push_back((uint8_t)(i * 37));
+    }
+    const uint32_t crc = TinyGPSDemux::crc24q(frame.data(), frame.size());
+    frame.push_back(crc >> 16);
+    frame.push_back(crc >> 8);
+    frame.push_back(crc);
+    return frame;
+}
+
+// A UBX payload that carries a valid sentence, as NAV or RXM data may by chance
+Bytes ubxWithSentence()
+{
+    Bytes payload{0x00, 0x24, 0xB5};
+    payload.insert(payload.end(), gga.begin(), gga.end());
+    return ubx(0x01, 0x07, payload);
+}
+
+void append(Bytes& stream, const Bytes& bytes)
+{
+    stream.insert(stream.end(), bytes.begin(), bytes.end());
+}
+void append(Bytes& stream, const std::string& s)
+{
+    stream.insert(stream.end(), s.begin(), s.end());
+}
+
+struct Seen
+{
+    TinyGPSFrame::Protocol protocol;
+    uint16_t type;
+    uint16_t length;
+    bool inInput;
+};
+struct FrameLog
+{
+    const Bytes* input{};
+    std::vector<Seen> frames;
+};
+void logFrame(const TinyGPSFrame& frame, void* context)
+{
+    FrameLog* log = static_cast<FrameLog*>(context);
+    const bool inInput = frame.data >= log->input->data() && frame.data < log->input->data() + log->input->size();
+    log->frames.push_back({frame.protocol, frame.type(), frame.length, inInput});
+}
+
+struct AckLog : public TinyGPSListener
+{
+    void onCommit(const TinyGPSPlus&, uint16_t) override {}
+    void onUbxAck(uint8_t msgClass, uint8_t msgId, bool ack) override
+    {
+        acks.push_back((uint16_t)(msgClass << 8 | msgId));
+        acked = ack;
+    }
+    std::vector<uint16_t> acks;
+    bool acked{};
+};
+}
+
+class TestTinyGpsDemux : public ::testing::Test
+{
+protected:
+    TestTinyGpsDemux()
+    {
+        append(mixed, rmc);
+        append(mixed, ubxWithSentence());
+        append(mixed, rtcm(1005, 19));
+        append(mixed, Bytes(ackRate, ackRate + sizeof(ackRate)));
+        append(mixed, gga);
+        append(mixed, rtcm(1077, 200));
+        log.input = &mixed;
+        gps.addListener(&acks);
+    }
+    TinyGPSPlus gps;
+    TinyGPSDemux demux{&gps, logFrame, &log};
+    Bytes mixed;
+    FrameLog log;
+    AckLog acks;
+};
+
+TEST_F(TestTinyGpsDemux, checksums)
+{
+    const std::string gsv{"GPGSV,4,4,13,32,08,058,20"};
+    EXPECT_EQ(0x4D, TinyGPSDemux::xorChecksum((const uint8_t*)gsv.data(), gsv.size()));
+    const uint8_t rate[] = {0x06, 0x08, 0x06, 0x00, 0x64, 0x00, 0x01, 0x00, 0x01, 0x00};
+    EXPECT_EQ(0x127A, TinyGPSDemux::fletcher8(rate, sizeof(rate)));
+    const std::string check{"123456789"};
+    EXPECT_EQ(0xCDE703u, TinyGPSDemux::crc24q((const uint8_t*)check.data(), check.size()));
+    // Incremental
+    const uint32_t head = TinyGPSDemux::crc24q((const uint8_t*)check.data(), 4);
+    EXPECT_EQ(0xCDE703u, TinyGPSDemux::crc24q((const uint8_t*)check.data() + 4, 5, head));
+}
+
+TEST_F(TestTinyGpsDemux, binaryFramesDoNotReachTheParser)
+{
+    // Without the demultiplexer the sentence inside the UBX payload is parsed
+    TinyGPSPlus raw;
+    for (uint8_t b : mixed)
+    {
+        raw.encode((char)b);
+    }
+    EXPECT_EQ(3u, raw.passedChecksum());
+
+    demux.feed(mixed.data(), mixed.size());
+    EXPECT_EQ(2u, gps.passedChecksum());
+    EXPECT_EQ(0u, gps.failedChecksum());
+    EXPECT_EQ(0u, gps.corruption.truncated + gps.corruption.nonPrintable + gps.corruption.missingChecksum);
+    EXPECT_EQ(2u, demux.frames.nmea);
+    EXPECT_EQ(2u, demux.frames.ubx);
+    EXPECT_EQ(2u, demux.frames.rtcm);
+    EXPECT_EQ(2u, demux.skipped); // the LF after each sentence
+
+    ASSERT_EQ(4u, log.frames.size());
+    EXPECT_EQ(TinyGPSFrame::UBX, log.frames[0].protocol);
+    EXPECT_EQ(0x0107, log.frames[0].type);
+    EXPECT_EQ(TinyGPSFrame::RTCM3, log.frames[1].protocol);
+    EXPECT_EQ(1005, log.frames[1].type);
+    EXPECT_EQ(25, log.frames[1].length);
+    EXPECT_EQ(0x0501, log.frames[2].type);
+    EXPECT_EQ(1077, log.frames[3].type);
+    for (const Seen& seen : log.frames)
+    {
+        EXPECT_TRUE(seen.inInput); // not copied
+    }
+    ASSERT_EQ(1u, acks.acks.size());
+    EXPECT_EQ(0x0608, acks.acks[0]);
+    EXPECT_TRUE(acks.acked);
+}
+
+TEST_F(TestTinyGpsDemux, framesSplitAcrossFeeds)
+{
+    TinyGPSPlus::EncodeStatus last = TinyGPSPlus::EncodeStatus::UNFINISHED;
+    std::vector<TinyGPSPlus::EncodeStatus> statuses;
+    for (size_t i = 0; i < mixed.size(); ++i)
+    {
+        size_t consumed = 0;
+        last = demux.feed(&mixed[i], 1, consumed);
+        EXPECT_EQ(1u, consumed);
+        if (last != TinyGPSPlus::EncodeStatus::UNFINISHED)
+            statuses.push_back(last);
+    }
+    ASSERT_EQ(2u, statuses.size());
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::RMC, statuses[0]);
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::GGA, statuses[1]);
+    EXPECT_EQ(2u, gps.passedChecksum());
+    ASSERT_EQ(4u, log.frames.size());
+    EXPECT_EQ(0x0107, log.frames[0].type);
+    EXPECT_EQ(1005, log.frames[1].type);
+    EXPECT_EQ(206, log.frames[3].length);
+    for (const Seen& seen : log.frames)
+    {
+        EXPECT_FALSE(seen.inInput); // assembled
+    }
+    EXPECT_EQ(1u, acks.acks.size());
+}
+
+TEST_F(TestTinyGpsDemux, resyncAfterFalseSyncAndBadChecksum)
+{
+    Bytes stream{0xB5, 0x62, 0x01, 0x07, 0xFF, 0xFF}; // longer than any UBX message
+    stream.push_back(0xD3);
+    stream.push_back(0xFF); // reserved bits set
+    Bytes corrupted = rtcm(1005, 19);
+    corrupted[10] ^= 0x01;
+    append(stream, corrupted);
+    append(stream, mixed);
+    log.input = &stream;
+
+    demux.feed(stream.data(), stream.size());
+    EXPECT_EQ(1u, demux.checksumErrors.rtcm);
+    EXPECT_EQ(0u, demux.checksumErrors.ubx);
+    EXPECT_EQ(2u, gps.passedChecksum());
+    EXPECT_EQ(0u, gps.failedChecksum());
+    ASSERT_EQ(4u, log.frames.size());
+    EXPECT_EQ(0x0107, log.frames[0].type);
+    EXPECT_EQ(1077, log.frames[3].type);
+
+    // The same, one byte per feed() as from Serial.read()
+    TinyGPSPlus bytewise;
+    FrameLog bytewiseLog;
+    bytewiseLog.input = &stream;
+    TinyGPSDemux serial{&bytewise, logFrame, &bytewiseLog};
+    for (uint8_t b : stream)
+    {
+        serial.feed(&b, 1);
+    }
+    EXPECT_EQ(1u, serial.checksumErrors.rtcm);
+    EXPECT_EQ(2u, bytewise.passedChecksum());
+    EXPECT_EQ(0u, bytewise.failedChecksum());
+    EXPECT_EQ(4u, bytewiseLog.frames.size());
+}
+
+TEST_F(TestTinyGpsDemux, falseSyncSpanningFeedsLosesNothing)
+{
+    // An RTCM3 header claiming 256 bytes, then sentences; and a UBX frame
+    // that lost a byte, so it swallows the start of the next sentence
+    Bytes stream{0xD3, 0x01, 0x00};
+    for (int i = 0; i < 5; ++i)
+    {
+        append(stream, rmc);
+    }
+    Bytes damaged = ubx(0x01, 0x07, Bytes(40, 0x11));
+    damaged.erase(damaged.begin() + 20);
+    append(stream, damaged);
+    for (int i = 0; i < 5; ++i)
+    {
+        append(stream, gga);
+    }
+    log.input = &stream;
+
+    for (uint8_t b : stream)
+    {
+        demux.feed(&b, 1);
+    }
+    EXPECT_EQ(10u, gps.passedChecksum());
+    EXPECT_EQ(0u, gps.failedChecksum());
+    EXPECT_EQ(1u, demux.checksumErrors.rtcm);
+    EXPECT_EQ(1u, demux.checksumErrors.ubx);
+}
+
+TEST_F(TestTinyGpsDemux, syncByteCutsSentenceShort)
+{
+    Bytes stream;
+    append(stream, rmc.substr(0, 30));
+    append(stream, Bytes(ackRate, ackRate + sizeof(ackRate)));
+    append(stream, gga);
+    demux.feed(stream.data(), stream.size());
+    EXPECT_EQ(1u, gps.corruption.nonPrintable);
+    EXPECT_EQ(1u, gps.passedChecksum());
+    EXPECT_EQ(1u, acks.acks.size());
+}
+
+TEST_F(TestTinyGpsDemux, sentencesWithoutParser)
+{
+    TinyGPSDemux framer{nullptr, logFrame, &log};
+    Bytes stream;
+    append(stream, rmc);
+    std::string bad = gga;
+    bad[20] = '9';
+    append(stream, bad);
+    append(stream, rtcm(1005, 19));
+    append(stream, std::string("$GPTXT,01,01,02,no CR*7D\n"));
+    log.input = &stream;
+
+    framer.feed(stream.data(), stream.size());
+    EXPECT_EQ(1u, framer.checksumErrors.nmea);
+    EXPECT_EQ(2u, framer.frames.nmea);
+    ASSERT_EQ(3u, log.frames.size());
+    EXPECT_EQ(TinyGPSFrame::NMEA, log.frames[0].protocol);
+    EXPECT_EQ(rmc.size(), log.frames[0].length);
+    EXPECT_EQ(TinyGPSFrame::RTCM3, log.frames[1].protocol);
+    EXPECT_EQ(TinyGPSFrame::NMEA, log.frames[2].protocol);
+}
@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+#include "TinyGPSFusion.h"
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+struct Epoch
+{
+    uint32_t second;      // seconds after 12:00:00
+    double lat;
+    double lng;
+    double hdop;
+    int satellites;
+};
+
+// A GGA for the simulated receiver
+std::string gga(const Epoch& e)
+{
+    char body[128];
+    const double lat = e.lat, lng = e.lng;
+    const int latDeg = (int)lat, lngDeg = (int)lng;
+    snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,%02d%08.5f,N,%03d%08.5f,E,1,%02d,%.2f,15.8,M,21.0,M,,",
+             12 + e.second / 3600, e.second / 60 % 60, e.second % 60,
+             latDeg, (lat - latDeg) * 60, lngDeg, (lng - lngDeg) * 60, e.satellites, e.hdop);
+    uint8_t parity = 0;
+    for (const char* p = body; *p; ++p)
+    {
+        parity ^= (uint8_t)*p;
+    }
+    char sentence[160];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, parity);
+    return sentence;
+}
+
+unsigned long now = 0;
+unsigned long fakeClock()
+{
+    return now;
+}
+
+void record(const TinyGPSFusedFix& fix, void* context)
+{
+    static_cast<std::vector<TinyGPSFusedFix>*>(context)->push_back(fix);
+}
+}
+
+// Two receivers fed from simulated streams. Each step advances the
+// fusion's clock by 'skewMs' between receiver A's and B's sentence of an
+// epoch; a negative skew makes B arrive first.
+class TestTinyGpsFusion : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        fusion.clock = fakeClock;
+        EXPECT_EQ(0, fusion.add(a));
+        EXPECT_EQ(1, fusion.add(b));
+    }
+    void encode(TinyGPSPlus& gps, const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+    }
+    // One epoch; an hdop below 0 means the receiver sends nothing
+    void step(uint32_t second, double hdopA, double hdopB, int skewMs, double offsetB = 0)
+    {
+        const Epoch ea{second, 65.0757, 25.4861, hdopA, 8};
+        const Epoch eb{second, 65.0757 + offsetB, 25.4861, hdopB, 8};
+        TinyGPSPlus& first = skewMs >= 0 ? a : b;
+        TinyGPSPlus& second_ = skewMs >= 0 ? b : a;
+        const Epoch& e1 = skewMs >= 0 ? ea : eb;
+        const Epoch& e2 = skewMs >= 0 ? eb : ea;
+        if (e1.hdop >= 0)
+            encode(first, gga(e1));
+        now += skewMs >= 0 ? skewMs : -skewMs;
+        if (e2.hdop >= 0)
+            encode(second_, gga(e2));
+        now += 1000 - (skewMs >= 0 ? skewMs : -skewMs);
+    }
+    TinyGPSPlus a, b;
+    std::vector<TinyGPSFusedFix> out;
+    TinyGPSFusion fusion{record, &out};
+};
+TEST_F(TestTinyGpsFusion, firstArrivalWinsEachEpochOnce)
+{
+    for (uint32_t s = 0; s < 10; ++s)
+    {
+        step(s, 1.2, 1.0, s < 5 ? 80 : -80);
+    }
+    ASSERT_EQ(10u, out.size());
+    for (uint32_t s = 0; s < 10; ++s)
+    {
+        EXPECT_EQ(s < 5 ? 0 : 1, out[s].receiver);
+        EXPECT_EQ(12000000u + s * 100, out[s].time);
+    }
+    EXPECT_EQ(5u, fusion.stats(0).selected);
+    EXPECT_EQ(5u, fusion.stats(0).late);
+    EXPECT_EQ(120, out[0].hdop);
+    EXPECT_EQ(8u, out[0].satellites);
+    EXPECT_FALSE(fusion.isDiverging(1));
+}
+TEST_F(TestTinyGpsFusion, poorFixFallsBackToLaterReceiver)
+{
+    step(0, 1.2, 1.0, 100);
+    step(1, 9.9, 1.0, 100);
+    step(2, 1.2, 1.0, 100);
+    ASSERT_EQ(3u, out.size());
+    EXPECT_EQ(0, out[0].receiver);
+    EXPECT_EQ(1, out[1].receiver);
+    EXPECT_EQ(0, out[2].receiver);
+    EXPECT_EQ(1u, fusion.stats(0).rejected);
+}
+TEST_F(TestTinyGpsFusion, staleReceiverDetected)
+{
+    step(0, 1.2, 1.0, 50);
+    EXPECT_FALSE(fusion.isStale(0));
+    for (uint32_t s = 1; s < 5; ++s)
+    {
+        step(s, -1, 1.0, 50);
+    }
+    EXPECT_TRUE(fusion.isStale(0));
+    EXPECT_FALSE(fusion.isStale(1));
+    EXPECT_TRUE(fusion.isStale(2)); // never added
+    EXPECT_FALSE(fusion.isDiverging(_GPS_FUSION_RECEIVERS));
+    EXPECT_EQ(0u, fusion.stats(255).fixes);
+    ASSERT_EQ(5u, out.size());
+    EXPECT_EQ(1, out[4].receiver);
+}
+TEST_F(TestTinyGpsFusion, divergingReceiverDetected)
+{
+    step(0, 1.2, 1.0, 50);
+    EXPECT_FALSE(fusion.isDiverging(1));
+    step(1, 1.2, 1.0, 50, 0.002); // ~220 m north
+    EXPECT_TRUE(fusion.isDiverging(1));
+    EXPECT_NEAR(222, fusion.separation(1), 5);
+    EXPECT_FALSE(fusion.isDiverging(0));
+    step(2, 1.2, 1.0, 50);
+    EXPECT_FALSE(fusion.isDiverging(1));
+}
+TEST_F(TestTinyGpsFusion, laggingClockDoesNotRepublishOldEpochs)
+{
+    // B reports each epoch one second behind A
+    for (uint32_t s = 1; s < 6; ++s)
+    {
+        encode(a, gga(Epoch{s, 65.0757, 25.4861, 1.2, 8}));
+        encode(b, gga(Epoch{s - 1, 65.0757, 25.4861, 1.0, 8}));
+        now += 1000;
+    }
+    ASSERT_EQ(5u, out.size());
+    for (const TinyGPSFusedFix& fix : out)
+    {
+        EXPECT_EQ(0, fix.receiver);
+    }
+    EXPECT_EQ(5u, fusion.stats(1).late);
+}
+TEST_F(TestTinyGpsFusion, receiversOutliveFusion)
+{
+    std::vector<TinyGPSFusedFix> scopedOut;
+    {
+        TinyGPSFusion scoped{record, &scopedOut};
+        EXPECT_EQ(0, scoped.add(a));
+        encode(a, gga(Epoch{0, 65.0757, 25.4861, 1.2, 8}));
+    }
+    encode(a, gga(Epoch{1, 65.0757, 25.4861, 1.2, 8}));
+    EXPECT_EQ(1u, scopedOut.size());
+    EXPECT_EQ(2u, out.size()); // the fixture's fusion is still attached
+}
@@ -0,0 +1,121 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSHub.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+class TestTinyGpsHub : public ::testing::Test
+{
+protected:
+    void SetUp()
+    {
+        char tmpl[] = "/tmp/tinygpshubXXXXXX";
+        dir = mkdtemp(tmpl);
+        socketPath = dir + "/fixes";
+        consumer = socket(AF_UNIX, SOCK_DGRAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, socketPath.c_str());
+        ASSERT_EQ(0, bind(consumer, (const sockaddr*)&addr, sizeof(addr)));
+        ASSERT_TRUE(hub.begin(socketPath.c_str()));
+    }
+    void TearDown()
+    {
+        close(consumer);
+        for (const std::string& fifo : fifos)
+        {
+            unlink(fifo.c_str());
+        }
+        unlink(socketPath.c_str());
+        rmdir(dir.c_str());
+    }
+    int addFifo()
+    {
+        std::string path = dir + "/gps" + std::to_string(fifos.size());
+        EXPECT_EQ(0, mkfifo(path.c_str(), 0600));
+        fifos.push_back(path);
+        EXPECT_EQ((int)fifos.size() - 1, hub.addDevice(path.c_str(), 9600));
+        return open(path.c_str(), O_WRONLY);
+    }
+    std::string receive()
+    {
+        char buf[256];
+        ssize_t len = recv(consumer, buf, sizeof(buf), MSG_DONTWAIT);
+        return len > 0 ? std::string(buf, len) : std::string();
+    }
+    TinyGPSHub hub;
+    std::string dir;
+    std::string socketPath;
+    std::vector<std::string> fifos;
+    int consumer;
+};
+TEST_F(TestTinyGpsHub, feedsOneParserPerDevice)
+{
+    const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    const std::string vtg{"$GPVTG,,T,,M,0.866,N,1.605,K,A*29\n"};
+    int first = addFifo();
+    int second = addFifo();
+    ASSERT_EQ(rmc.size(), write(first, rmc.data(), rmc.size()));
+    ASSERT_EQ(vtg.size(), write(second, vtg.data(), vtg.size()));
+    int serviced = 0;
+    while (serviced < 2)
+    {
+        int n = hub.poll(1000);
+        ASSERT_GT(n, 0);
+        serviced += n;
+    }
+    EXPECT_EQ(2, hub.deviceCount());
+    EXPECT_EQ(rmc.size(), hub.stats(0).bytes);
+    EXPECT_EQ(1, hub.stats(0).sentences);
+    EXPECT_EQ(1, hub.stats(0).fixes);
+    EXPECT_EQ(vtg.size(), hub.stats(1).bytes);
+    EXPECT_EQ(1, hub.stats(1).sentences);
+    EXPECT_EQ(0, hub.stats(1).fixes);
+    EXPECT_TRUE(hub.gps(1).groundSpeed.isValid());
+    EXPECT_EQ(std::string("0,251220,12253100,65.0757245,25.4865483,0,0\n"), receive());
+    EXPECT_EQ(std::string(), receive());
+    close(first);
+    close(second);
+}
+TEST_F(TestTinyGpsHub, hdopInHundredths)
+{
+    const std::string gga{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"};
+    int fd = addFifo();
+    ASSERT_EQ(gga.size(), write(fd, gga.data(), gga.size()));
+    ASSERT_GT(hub.poll(1000), 0);
+    EXPECT_EQ(std::string("0,0,12253100,65.0757245,25.4865483,8,250\n"), receive());
+    close(fd);
+}
+TEST_F(TestTinyGpsHub, timesOutWithoutInput)
+{
+    int fd = addFifo();
+    EXPECT_EQ(0, hub.poll(10));
+    EXPECT_EQ(0, hub.stats(0).bytes);
+    close(fd);
+}
+TEST_F(TestTinyGpsHub, hangupClosesDevice)
+{
+    // The receiver is the slave side of a pty; closing the master is an unplug
+    const int master = posix_openpt(O_RDWR | O_NOCTTY);
+    ASSERT_GE(master, 0);
+    ASSERT_EQ(0, grantpt(master));
+    ASSERT_EQ(0, unlockpt(master));
+    ASSERT_EQ(0, hub.addDevice(ptsname(master), 9600));
+
+    const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    ASSERT_EQ(rmc.size(), write(master, rmc.data(), rmc.size()));
+    ASSERT_EQ(1, hub.poll(1000));
+    EXPECT_EQ(1, hub.stats(0).sentences);
+    EXPECT_FALSE(hub.stats(0).closed);
+
+    close(master);
+    EXPECT_EQ(1, hub.poll(1000));
+    EXPECT_TRUE(hub.stats(0).closed);
+    // Not reported again: the wait times out instead of spinning
+    EXPECT_EQ(0, hub.poll(10));
+    EXPECT_EQ(1, hub.stats(0).sentences);
+}
@@ -0,0 +1,112 @@
+#include "gtest/gtest.h"
+#include "TinyGPSPlanner.h"
+
+namespace
+{
+const uint16_t allSix = TinyGPSPlanner::RMC | TinyGPSPlanner::GGA | TinyGPSPlanner::GSA |
+                        TinyGPSPlanner::GSV | TinyGPSPlanner::VTG | TinyGPSPlanner::GLL;
+const std::string rmc{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\r\n"};
+const std::string gga{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\r\n"};
+}
+
+class TestTinyGpsPlanner : public ::testing::Test
+{
+protected:
+    void encode(const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+    }
+    uint8_t out[512]{};
+    TinyGPSMemoryStream stream{nullptr, 0, out, sizeof(out)};
+    TinyGPSPlus gps{stream};
+    TinyGPSPlanner planner{gps, 9600};
+};
+TEST_F(TestTinyGpsPlanner, utilisationOfLink)
+{
+    EXPECT_EQ(100, TinyGPSPlanner::utilisation(96, 100, 9600));
+    EXPECT_EQ(50, TinyGPSPlanner::utilisation(480, 1000, 9600));
+    EXPECT_EQ(255, TinyGPSPlanner::utilisation(1000, 100, 9600));
+}
+TEST_F(TestTinyGpsPlanner, sentenceSizesLearnedFromStats)
+{
+    encode(rmc);
+    encode(gga);
+    EXPECT_EQ(rmc.size(), gps.sentenceBytes.rmc);
+    EXPECT_EQ(gga.size(), gps.sentenceBytes.gga);
+    EXPECT_EQ(rmc.size() + gga.size(), planner.bytesPerEpoch(TinyGPSPlanner::RMC | TinyGPSPlanner::GGA));
+    encode(rmc);
+    encode(gga);
+    EXPECT_EQ(rmc.size() + gga.size(), planner.bytesPerEpoch(TinyGPSPlanner::RMC | TinyGPSPlanner::GGA));
+}
+TEST_F(TestTinyGpsPlanner, fasterBaudKeepsEverySentence)
+{
+    const TinyGPSPlan plan = planner.plan(allSix, 100, 115200);
+    EXPECT_TRUE(plan.feasible);
+    EXPECT_EQ(allSix, plan.sentences);
+    EXPECT_EQ(100, plan.periodMs);
+    EXPECT_EQ(115200, plan.baud);
+    EXPECT_LE(plan.utilisation, _GPS_PLAN_MAX_LOAD);
+}
+TEST_F(TestTinyGpsPlanner, slowLinkDropsSentencesThenRate)
+{
+    const TinyGPSPlan plan = planner.plan(allSix, 100, 9600);
+    EXPECT_TRUE(plan.feasible);
+    EXPECT_EQ(TinyGPSPlanner::RMC | TinyGPSPlanner::GGA, plan.sentences);
+    EXPECT_EQ(200, plan.periodMs);
+    EXPECT_EQ(9600, plan.baud);
+    EXPECT_EQ(75, plan.utilisation);
+}
+TEST_F(TestTinyGpsPlanner, requestThatFitsIsKept)
+{
+    const TinyGPSPlan plan = planner.plan(allSix, 1000, 115200);
+    EXPECT_EQ(allSix, plan.sentences);
+    EXPECT_EQ(9600, plan.baud);
+    EXPECT_EQ(52, plan.utilisation);
+}
+TEST_F(TestTinyGpsPlanner, applySendsBaudOutputAndRate)
+{
+    const TinyGPSPlan plan = planner.plan(allSix, 100, 115200);
+    planner.apply(plan);
+    EXPECT_EQ(115200, stream.baud());
+    EXPECT_EQ(115200, planner.baud());
+    const std::string written((const char*)out, stream.written());
+    EXPECT_EQ(0, written.find("$PUBX,41,1,0007,0003,115200,0*18\r\n"));
+    EXPECT_NE(std::string::npos, written.find("$PUBX,40,GSV,0,1,0,0,0,0*58\r\n"));
+    EXPECT_NE(std::string::npos, written.find("$PUBX,40,VTG,0,1,0,0,0,0*5F\r\n"));
+    EXPECT_EQ(std::string::npos, written.find("ZDA")); // off unless asked for
+    EXPECT_EQ(std::string::npos, written.find("GNS"));
+    const std::string rate((const char*)gps.sentence_100msPeriod, sizeof(gps.sentence_100msPeriod));
+    EXPECT_EQ(written.size() - rate.size() - 2, written.find(rate));
+}
+TEST_F(TestTinyGpsPlanner, applyWaitsForPubx41BeforeSwitching)
+{
+    const uint32_t start = millis();
+    planner.apply(planner.plan(allSix, 100, 115200));
+    EXPECT_LE(36u, millis() - start); // 35 bytes at 9600 baud
+}
+TEST_F(TestTinyGpsPlanner, optionalSentenceSwitchedOffOnceEnabled)
+{
+    planner.apply(planner.plan(TinyGPSPlanner::RMC | TinyGPSPlanner::ZDA, 1000));
+    planner.apply(planner.plan(TinyGPSPlanner::RMC, 1000));
+    const std::string written((const char*)out, stream.written());
+    EXPECT_NE(std::string::npos, written.find("$PUBX,40,ZDA,0,1,0,0,0,0*45\r\n"));
+    EXPECT_NE(std::string::npos, written.find("$PUBX,40,ZDA,0,0,0,0,0,0*44\r\n"));
+    EXPECT_EQ(std::string::npos, written.find("GST"));
+}
+TEST_F(TestTinyGpsPlanner, sentenceSizesWithoutCr)
+{
+    std::string lfOnly = rmc;
+    lfOnly.erase(lfOnly.size() - 2, 1);
+    encode(lfOnly);
+    EXPECT_EQ(lfOnly.size(), gps.sentenceBytes.rmc);
+}
+TEST_F(TestTinyGpsPlanner, measuredUtilisationFromReceivedBytes)
+{
+    planner.measuredUtilisation();
+    delay(100);
+    encode(std::string(48, 'x'));
+    EXPECT_EQ(50, planner.measuredUtilisation());
+}
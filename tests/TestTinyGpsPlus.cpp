@@ -104,7 +104,7 @@ TEST_F(TestTinyGpsPlus, encodeCustomGSV_NineSatsInViewOneId)
 TEST_F(TestTinyGpsPlus, encodeGSV_TwoSatsTwice)
 {
     std::string s1{"$GPGSV,1,1,02,07,,,32,21,,,31*7C\n"};
-    std::string s2{"$GPGSV,1,1,02,07,,,35,21,,,37*7C\n"};
+    std::string s2{"$GPGSV,1,1,02,07,,,35,21,,,37*7D\n"};
     encode(s1);
     encode(s2);
     EXPECT_EQ(true, gps->satsInView.isUpdated());
@@ -238,3 +238,417 @@ TEST_F(TestTinyGpsPlus, encode_EncodeStatus)
     encodeAndCheckStatus(s1, TinyGPSPlus::EncodeStatus::RMC);
     encodeAndCheckStatus(s2, TinyGPSPlus::EncodeStatus::GGA);
 }
+#if _GPS_SATS_BACK_BUFFER
+TEST_F(TestTinyGpsPlus, encodeGSV_PartialGroupNotPublished)
+{
+    std::string s1{"$GPGSV,3,1,09,05,45,242,14,07,57,095,33,08,21,080,31,09,12,126,13*72\n"};
+    std::string s2{"$GPGSV,3,2,09,13,39,278,27,15,09,295,,21,18,341,29,27,24,040,26*76\n"};
+    encode(s1);
+    encode(s2);
+    EXPECT_EQ(false, gps->satsInView.isUpdated());
+    EXPECT_EQ(false, gps->satsInView.isValid());
+    EXPECT_EQ(0, gps->satsInView.numOf());
+    EXPECT_EQ(0, gps->satsInView.numOfDb());
+}
+TEST_F(TestTinyGpsPlus, encodeGSV_PreviousGroupVisibleWhileAssembling)
+{
+    std::string s0{"$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n"};
+    std::string s1{"$GPGSV,3,1,09,05,45,242,14,07,57,095,33,08,21,080,31,09,12,126,13*72\n"};
+    std::string s2{"$GPGSV,3,2,09,13,39,278,27,15,09,295,,21,18,341,29,27,24,040,26*76\n"};
+    std::string s3{"$GPGSV,3,3,09,30,71,180,22*4C\n"};
+    encode(s0);
+    encode(s1);
+    encode(s2);
+    EXPECT_EQ(4, gps->satsInView.numOf());
+    EXPECT_EQ(4, gps->satsInView.numOfDb());
+    EXPECT_EQ(117, gps->satsInView.totalSnr());
+    encode(s3);
+    EXPECT_EQ(9, gps->satsInView.numOf());
+    EXPECT_EQ(9, gps->satsInView.numOfDb());
+    EXPECT_EQ(195, gps->satsInView.totalSnr());
+}
+TEST_F(TestTinyGpsPlus, encodeGSV_GroupWithMissingMessageDiscarded)
+{
+    std::string s0{"$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n"};
+    std::string s1{"$GPGSV,3,1,09,05,45,242,14,07,57,095,33,08,21,080,31,09,12,126,13*72\n"};
+    std::string s3{"$GPGSV,3,3,09,30,71,180,22*4C\n"};
+    encode(s0);
+    encode(s1);
+    encode(s3);
+    EXPECT_EQ(4, gps->satsInView.numOf());
+    EXPECT_EQ(7, gps->satsInView[0].id());
+    EXPECT_EQ(117, gps->satsInView.totalSnr());
+}
+#endif // _GPS_SATS_BACK_BUFFER
+TEST_F(TestTinyGpsPlus, encode_JunkBeforeSentenceSkipped)
+{
+    std::string s{"6,E,1,05,3.69,117.3,M,21.0,M,,*56\n$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n"};
+    encode(s);
+    EXPECT_EQ(1, gps->passedChecksum());
+    EXPECT_EQ(0, gps->failedChecksum());
+    EXPECT_EQ(5, gps->satellites.value());
+}
+TEST_F(TestTinyGpsPlus, encode_FramingErrorsCountedByCause)
+{
+    encode("$GPGGA,175628.00,6504.56965123456789,N*56\n");
+    EXPECT_EQ(1, gps->corruption.overlongTerm);
+    encode("$GPGGA,175628.00,65\x01""04.56965,N*56\n");
+    EXPECT_EQ(1, gps->corruption.nonPrintable);
+    encode("$GPGGA,175628.00,6504.56965,N\n");
+    EXPECT_EQ(1, gps->corruption.missingChecksum);
+    encode("$GPGGA,175628.00,6504.5$GPVTG,,,,,,,,,N*30\n");
+    EXPECT_EQ(1, gps->corruption.truncated);
+    EXPECT_EQ(1, gps->passedChecksum());
+    EXPECT_EQ(0, gps->failedChecksum());
+    EXPECT_FALSE(gps->time.isValid());
+    EXPECT_TRUE(gps->groundSpeed.isValid());
+}
+TEST_F(TestTinyGpsPlus, encode_BulkBufferStopsAtEachSentence)
+{
+    std::string s{"\xff\xfe junk $GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"
+                  "noise$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"};
+    size_t consumed{0};
+    size_t offset{0};
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::RMC, gps->encodeGiveStatus(s.data(), s.size(), consumed));
+    offset += consumed;
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::GGA, gps->encodeGiveStatus(s.data() + offset, s.size() - offset, consumed));
+    offset += consumed;
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::UNFINISHED, gps->encodeGiveStatus(s.data() + offset, s.size() - offset, consumed));
+    offset += consumed;
+    EXPECT_EQ(s.size(), offset);
+    EXPECT_EQ(s.size(), gps->charsProcessed());
+    EXPECT_EQ(2, gps->passedChecksum());
+}
+TEST_F(TestTinyGpsPlus, timestamp_DaysFromCivil)
+{
+    EXPECT_EQ(0, TinyGPSTimestamp::daysFromCivil(1970, 1, 1));
+    EXPECT_EQ(10957, TinyGPSTimestamp::daysFromCivil(2000, 1, 1));
+    EXPECT_EQ(11017, TinyGPSTimestamp::daysFromCivil(2000, 3, 1));
+    EXPECT_EQ(18621, TinyGPSTimestamp::daysFromCivil(2020, 12, 25));
+}
+TEST_F(TestTinyGpsPlus, timestamp_CommittedWithRmc)
+{
+    EXPECT_FALSE(gps->timestamp.isValid());
+    encode("$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n");
+    EXPECT_TRUE(gps->timestamp.isValid());
+    EXPECT_TRUE(gps->timestamp.isUpdated());
+    EXPECT_EQ(1608899131UL, gps->timestamp.unixSeconds());
+    EXPECT_EQ(0, gps->timestamp.centisecond());
+    EXPECT_EQ(1608899131000ULL, gps->timestamp.unixMillis());
+    EXPECT_FALSE(gps->timestamp.isUpdated());
+}
+TEST_F(TestTinyGpsPlus, timestamp_GgaNeedsDateAndWrapsAtMidnight)
+{
+    encode("$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n");
+    EXPECT_FALSE(gps->timestamp.isValid());
+    encode("$GPRMC,235959.50,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*79\n");
+    EXPECT_EQ(1608940799UL, gps->timestamp.unixSeconds());
+    EXPECT_EQ(50, gps->timestamp.centisecond());
+    encode("$GPGGA,000000.50,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*60\n");
+    EXPECT_EQ(1608940800UL, gps->timestamp.unixSeconds());
+}
+TEST_F(TestTinyGpsPlus, encodeZDA_DateAndTime)
+{
+    encodeAndCheckStatus("$GPZDA,201530.00,04,07,2002,00,00*60\n", TinyGPSPlus::EncodeStatus::ZDA);
+    EXPECT_EQ(1, gps->stats.zda);
+    EXPECT_TRUE(gps->date.isValid());
+    EXPECT_EQ(2002, gps->date.year());
+    EXPECT_EQ(7, gps->date.month());
+    EXPECT_EQ(4, gps->date.day());
+    EXPECT_EQ(20, gps->time.hour());
+    EXPECT_EQ(15, gps->time.minute());
+    EXPECT_EQ(30, gps->time.second());
+    EXPECT_TRUE(gps->timestamp.isValid());
+}
+TEST_F(TestTinyGpsPlus, encodeGST_ErrorEstimate)
+{
+    encodeAndCheckStatus("$GNGST,082356.00,1.8,,,,1.7,1.3,2.2*60\n", TinyGPSPlus::EncodeStatus::GST);
+    EXPECT_EQ(1, gps->stats.gst);
+    EXPECT_TRUE(gps->gst.rms.isValid());
+    EXPECT_EQ(180, gps->gst.rms.value());
+    EXPECT_EQ(170, gps->gst.latitude.value());
+    EXPECT_EQ(130, gps->gst.longitude.value());
+    EXPECT_EQ(220, gps->gst.altitude.value());
+}
+TEST_F(TestTinyGpsPlus, encodeGNS_FixLikeGga)
+{
+    encodeAndCheckStatus("$GNGNS,122310.2,,,,,NNN,00,,,,,,V*78\n", TinyGPSPlus::EncodeStatus::GNS);
+    EXPECT_FALSE(gps->location.isValid());
+    EXPECT_TRUE(gps->satellites.isValid());
+    encodeAndCheckStatus("$GNGNS,122310.2,3722.425671,N,12258.856215,W,AAN,14,0.9,1005.543,6.5,,,V*40\n", TinyGPSPlus::EncodeStatus::GNS);
+    EXPECT_EQ(2, gps->stats.gns);
+    EXPECT_EQ(1, gps->sentencesWithFix());
+    EXPECT_TRUE(gps->location.isValid());
+    EXPECT_NEAR(37.373761, gps->location.lat(), 1e-6);
+    EXPECT_NEAR(-122.980937, gps->location.lng(), 1e-6);
+    EXPECT_EQ(14, gps->satellites.value());
+    EXPECT_EQ(90, gps->hdop.value());
+    EXPECT_EQ(100554, gps->altitude.value());
+}
+TEST_F(TestTinyGpsPlus, encodeTXT_TextLongerThanTermBuffer)
+{
+    encodeAndCheckStatus("$GPTXT,01,01,02,u-blox ag - www.u-blox.com*50\n", TinyGPSPlus::EncodeStatus::TXT);
+    EXPECT_STREQ("u-blox ag - www.u-blox.com", gps->txt.value());
+    EXPECT_EQ(2, gps->txt.type());
+    encodeAndCheckStatus("$GPTXT,01,01,01,ANTSTATUS=OPEN and some extra words to exceed the term buffer by a long way*19\n",
+        TinyGPSPlus::EncodeStatus::TXT);
+    EXPECT_STREQ("ANTSTATUS=OPEN and some extra words to exceed the term buffer by", gps->txt.value());
+    EXPECT_EQ(1, gps->txt.type());
+    EXPECT_EQ(0, gps->corruption.overlongTerm);
+    EXPECT_EQ(2, gps->stats.txt);
+}
+TEST_F(TestTinyGpsPlus, parseFixed_RoundsToScale)
+{
+    EXPECT_EQ(87, TinyGPSPlus::parseFixed("0.866", 2));
+    EXPECT_EQ(866, TinyGPSPlus::parseFixed("0.866", 3));
+    EXPECT_EQ(8660, TinyGPSPlus::parseFixed("0.866", 4));
+    EXPECT_EQ(1, TinyGPSPlus::parseFixed("0.866", 0));
+    EXPECT_EQ(-1580, TinyGPSPlus::parseFixed("-15.8", 2));
+    EXPECT_EQ(-1581, TinyGPSPlus::parseFixed("-15.805", 2));
+    EXPECT_EQ(1200, TinyGPSPlus::parseFixed("12", 2));
+    EXPECT_EQ(8, TinyGPSPlus::parseFixed("08", 0));
+    EXPECT_EQ(0, TinyGPSPlus::parseFixed("", 2));
+}
+TEST_F(TestTinyGpsPlus, rescale_Rounds)
+{
+    EXPECT_EQ(8660, TinyGPSPlus::rescale(866, 3, 4));
+    EXPECT_EQ(87, TinyGPSPlus::rescale(866, 3, 2));
+    EXPECT_EQ(-87, TinyGPSPlus::rescale(-866, 3, 2));
+    EXPECT_EQ(1173, TinyGPSPlus::rescale(11730, 2, 1));
+}
+TEST_F(TestTinyGpsPlus, fixedFields_ShareOneLayout)
+{
+    EXPECT_EQ(sizeof(gps->speed), sizeof(gps->hdop));
+    EXPECT_EQ(sizeof(gps->speed), sizeof(TinyGPSFixed<5>));
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    EXPECT_EQ(87, gps->speed.value());
+    EXPECT_DOUBLE_EQ(0.87, gps->speed.knots());
+}
+TEST_F(TestTinyGpsPlus, lazyDecoding_OnlySubscribedFieldsCommitted)
+{
+    gps->enableLazyDecoding((1u << TinyGPSSnapshot::LOCATION) | (1u << TinyGPSSnapshot::TIME));
+    encode("$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n");
+    EXPECT_EQ(1, gps->sentencesWithFix());
+    EXPECT_TRUE(gps->location.isValid());
+    EXPECT_NEAR(65.076161, gps->location.lat(), 1e-6);
+    EXPECT_NEAR(25.486113, gps->location.lng(), 1e-6);
+    EXPECT_TRUE(gps->time.isValid());
+    EXPECT_EQ(17, gps->time.hour());
+    EXPECT_FALSE(gps->satellites.isValid());
+    EXPECT_FALSE(gps->hdop.isValid());
+    EXPECT_FALSE(gps->altitude.isValid());
+
+    gps->disableLazyDecoding();
+    encode("$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n");
+    EXPECT_EQ(5, gps->satellites.value());
+    EXPECT_EQ(11730, gps->altitude.value());
+}
+#if _GPS_LAZY_BUFFER_SIZE
+TEST_F(TestTinyGpsPlus, lazyDecoding_FailedChecksumLeavesNoStagedValues)
+{
+    gps->enableLazyDecoding();
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    EXPECT_EQ(87, gps->speed.value());
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,12.5,,081019,,,A*44\n");
+    EXPECT_EQ(1, gps->failedChecksum());
+    // An empty term keeps the staged value, which must not be the corrupted one
+    encode("$GPRMC,175629.00,A,6504.56965,N,02529.16680,E,,,081019,,,A*5A\n");
+    EXPECT_EQ(87, gps->speed.value());
+    EXPECT_EQ(29, gps->time.second());
+}
+TEST_F(TestTinyGpsPlus, lazyDecoding_OverflowDropsSentence)
+{
+    gps->enableLazyDecoding();
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    EXPECT_EQ(0u, gps->lazyOverflows());
+    // Longer than NMEA allows; dropped rather than decoded out of order
+    encode("$GPRMC,175628.0000000,A,6504.569650000,N,02529.16680000,E,0.866000000000,77.52000000000,081019,,,A*54\n");
+    EXPECT_EQ(2u, gps->passedChecksum());
+    EXPECT_EQ(1u, gps->lazyOverflows());
+    EXPECT_EQ(0, gps->course.value());
+    EXPECT_EQ(1u, gps->stats.rmc);
+    // Nor does a corrupted one reach the fields
+    encode("$GPRMC,175629.0000000,A,6504.569650000,N,02529.16680000,E,0.866000000000,77.52000000000,081019,,,A*00\n");
+    EXPECT_EQ(2u, gps->lazyOverflows());
+    EXPECT_EQ(0, gps->course.value());
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    EXPECT_EQ(17562800u, gps->time.value());
+}
+#endif // _GPS_LAZY_BUFFER_SIZE
+TEST_F(TestTinyGpsPlus, lazyDecoding_AllFieldsMatchEagerDecoding)
+{
+    const std::string log{
+        "$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n"
+        "$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n"
+        "$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\n"
+        "$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n"};
+    TinyGPSPlus eager;
+    for (char c : log)
+    {
+        eager.encode(c);
+    }
+    gps->enableLazyDecoding();
+    encode(log);
+    TinyGPSSnapshot a, b;
+    eager.snapshot(a);
+    gps->snapshot(b);
+    EXPECT_EQ(a.rawLat.billionths, b.rawLat.billionths);
+    EXPECT_EQ(a.time, b.time);
+    EXPECT_EQ(a.speed, b.speed);
+    EXPECT_EQ(a.altitude, b.altitude);
+    EXPECT_EQ(a.satellites, b.satellites);
+    EXPECT_EQ(a.satsInView, b.satsInView);
+    EXPECT_EQ(a.pdop, b.pdop);
+    EXPECT_EQ(a.gsaNumSats, b.gsaNumSats);
+    EXPECT_EQ(117, gps->satsInView.totalSnr());
+}
+namespace
+{
+struct SentenceCounter : TinyGPSListener
+{
+    void onCommit(const TinyGPSPlus&, uint16_t) override {}
+    void onSentence(const TinyGPSSentenceView& sentence) override
+    {
+        ++sentences;
+        lastAddress = sentence[0];
+    }
+    int sentences{0};
+    std::string lastAddress;
+};
+const std::string pubx00{"$PUBX,00,081350.00,4717.113210,N,00833.915187,E,546.589,G3,2.1,2.0,0.007,77.52,0.007,,0.92,1.19,0.77,9,0,0*5F\n"};
+}
+TEST_F(TestTinyGpsPlus, sentenceView_IndexesEveryTerm)
+{
+    TinyGPSSentenceBuffer<> view;
+    SentenceCounter counter;
+    gps->setSentenceView(&view);
+    gps->addListener(&counter);
+    encode(pubx00);
+    ASSERT_TRUE(view.isValid());
+    EXPECT_FALSE(view.isTruncated());
+    EXPECT_EQ(21, view.size());
+    EXPECT_STREQ("PUBX", view[0]);
+    EXPECT_STREQ("00", view[1]);
+    EXPECT_STREQ("4717.113210", view[3]);
+    EXPECT_EQ(11, view.length(3));
+    EXPECT_STREQ("", view[14]);
+    EXPECT_EQ(0, view.length(14));
+    EXPECT_STREQ("0", view[20]);
+    EXPECT_STREQ("", view[21]);
+    EXPECT_EQ(1, counter.sentences);
+    EXPECT_EQ("PUBX", counter.lastAddress);
+
+    encode("$GPRMC,175404.00,V,,,,,,,081019,,,N*7F\n");
+    EXPECT_EQ(2, counter.sentences);
+    EXPECT_EQ("GPRMC", counter.lastAddress);
+    encode("$PUBX,00,0813");
+    EXPECT_FALSE(view.isValid());
+}
+TEST_F(TestTinyGpsPlus, sentenceView_FailedChecksumNotReported)
+{
+    TinyGPSSentenceBuffer<> view;
+    SentenceCounter counter;
+    gps->setSentenceView(&view);
+    gps->addListener(&counter);
+    std::string corrupted{pubx00};
+    corrupted[10] = '9';
+    encode(corrupted);
+    EXPECT_FALSE(view.isValid());
+    EXPECT_EQ(0, counter.sentences);
+}
+TEST_F(TestTinyGpsPlus, snapshot_CarriesCommitCountsAndTime)
+{
+    TinyGPSSnapshot snap;
+    gps->snapshot(snap);
+    EXPECT_FALSE(snap.isValid(TinyGPSSnapshot::LOCATION));
+    EXPECT_EQ(0u, snap.lastCommitTime);
+
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    const uint32_t committed = millis();
+    encode("$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n");
+    delay(20);
+    gps->snapshot(snap);
+    EXPECT_EQ(2u, snap.version[TinyGPSSnapshot::LOCATION]);
+    EXPECT_EQ(1u, snap.version[TinyGPSSnapshot::DATE]);
+    EXPECT_EQ(1u, snap.version[TinyGPSSnapshot::ALTITUDE]);
+    EXPECT_FALSE(snap.isValid(TinyGPSSnapshot::GSA));
+    EXPECT_LE(committed, snap.lastCommitTime);
+    EXPECT_GE(millis() - 20, snap.lastCommitTime); // not the time of the copy
+}
+TEST_F(TestTinyGpsPlus, removeListener_StopsCallbacks)
+{
+    SentenceCounter first, second, third;
+    TinyGPSSentenceBuffer<> view;
+    gps->setSentenceView(&view);
+    gps->addListener(&first);
+    gps->addListener(&second);
+    gps->addListener(&third);
+    encode(pubx00);
+    gps->removeListener(&second);
+    gps->removeListener(&third);
+    gps->removeListener(&third); // not listening any more
+    encode(pubx00);
+    EXPECT_EQ(2, first.sentences);
+    EXPECT_EQ(1, second.sentences);
+    EXPECT_EQ(1, third.sentences);
+    {
+        SentenceCounter scoped;
+        gps->addListener(&scoped);
+        encode(pubx00);
+        gps->removeListener(&scoped);
+    }
+    encode(pubx00);
+    EXPECT_EQ(4, first.sentences);
+}
+TEST_F(TestTinyGpsPlus, sentenceView_TruncatedWhenBufferIsFull)
+{
+    TinyGPSSentenceBuffer<32, 8> view;
+    gps->setSentenceView(&view);
+    encode(pubx00);
+    EXPECT_TRUE(view.isValid());
+    EXPECT_TRUE(view.isTruncated());
+    EXPECT_EQ(5, view.size());
+    EXPECT_STREQ("N", view[4]);
+}
+TEST_F(TestTinyGpsPlus, changedSince_CollectsCommittedFieldsPerToken)
+{
+    const uint16_t position = (1u << TinyGPSSnapshot::LOCATION) | (1u << TinyGPSSnapshot::SPEED);
+    TinyGPSPlus::ChangeToken telemetry = gps->takeChangeToken();
+    ASSERT_NE(TinyGPSPlus::NO_CHANGE_TOKEN, telemetry);
+    EXPECT_EQ(0, gps->changedSince(telemetry));
+
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    TinyGPSPlus::ChangeToken logger = gps->takeChangeToken();
+    EXPECT_EQ(position, gps->changedSince(telemetry) & position);
+    EXPECT_EQ(0, gps->changedSince(logger));
+
+    // Reading through peek() leaves both the mask and isUpdated() alone
+    EXPECT_EQ(87, gps->speed.peek());
+    EXPECT_TRUE(gps->speed.isUpdated());
+    EXPECT_EQ(position, gps->changedSince(telemetry) & position);
+
+    gps->acknowledge(telemetry, position);
+    EXPECT_EQ(0, gps->changedSince(telemetry) & position);
+    EXPECT_NE(0, gps->changedSince(telemetry) & (1u << TinyGPSSnapshot::TIME));
+    gps->acknowledge(telemetry);
+    EXPECT_EQ(0, gps->changedSince(telemetry));
+
+    encode("$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n");
+    const uint16_t gga = gps->changedSince(telemetry);
+    EXPECT_TRUE(gga & (1u << TinyGPSSnapshot::ALTITUDE));
+    EXPECT_FALSE(gga & (1u << TinyGPSSnapshot::SPEED));
+    EXPECT_EQ(gga, gps->changedSince(logger));
+}
+TEST_F(TestTinyGpsPlus, changedSince_TokensAreLimited)
+{
+    TinyGPSPlus::ChangeToken tokens[_GPS_CHANGE_TOKENS];
+    for (auto& token : tokens)
+    {
+        token = gps->takeChangeToken();
+        EXPECT_NE(TinyGPSPlus::NO_CHANGE_TOKEN, token);
+    }
+    EXPECT_EQ(TinyGPSPlus::NO_CHANGE_TOKEN, gps->takeChangeToken());
+    EXPECT_EQ((1u << TinyGPSSnapshot::FIELD_COUNT) - 1, gps->changedSince(TinyGPSPlus::NO_CHANGE_TOKEN));
+    gps->releaseChangeToken(tokens[1]);
+    EXPECT_EQ(tokens[1], gps->takeChangeToken());
+}
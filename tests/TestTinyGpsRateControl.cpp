@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+#include "TinyGPSRateControl.h"
+#include "TinyGPSCommands.h"
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+// RMC of a simulated track, one per second after 12:00:00
+std::string rmc(uint32_t second, double knots, double course, double lat = 65.0757, double lng = 25.4861)
+{
+    char body[128];
+    const int latDeg = (int)lat, lngDeg = (int)lng;
+    snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.00,A,%02d%08.5f,N,%03d%08.5f,E,%.3f,%.2f,251220,,,A",
+             (12 + second / 3600) % 24, second / 60 % 60, second % 60,
+             latDeg, (lat - latDeg) * 60, lngDeg, (lng - lngDeg) * 60, knots, course);
+    uint8_t parity = 0;
+    for (const char* p = body; *p; ++p)
+    {
+        parity ^= (uint8_t)*p;
+    }
+    char sentence[160];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, parity);
+    return sentence;
+}
+const uint8_t ackRate[] = {0xB5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x08, 0x16, 0x3F};
+}
+
+class TestTinyGpsRateControl : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // parked 5 s, walking 1 s, driving 0.2 s
+        EXPECT_TRUE(rate.addLevel(5000, 0));
+        EXPECT_TRUE(rate.addLevel(1000, 300));
+        EXPECT_TRUE(rate.addLevel(200, 2000));
+        rate.turnLevel = 2;
+    }
+    void encode(const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+        ++second;
+    }
+    void drive(double knots, double course = 90, int seconds = 1)
+    {
+        for (int i = 0; i < seconds; ++i)
+        {
+            encode(rmc(second, knots, course));
+        }
+    }
+    // Periods of the CFG-RATE frames sent so far
+    std::vector<uint16_t> periods() const
+    {
+        std::vector<uint16_t> ret;
+        for (size_t i = 0; i + 8 <= stream.written(); ++i)
+        {
+            if (out[i] == 0xB5 && out[i + 1] == 0x62 && out[i + 2] == 0x06 && out[i + 3] == 0x08)
+            {
+                ret.push_back(out[i + 6] | out[i + 7] << 8);
+            }
+        }
+        return ret;
+    }
+    uint8_t out[2048]{};
+    TinyGPSMemoryStream stream{nullptr, 0, out, sizeof(out)};
+    TinyGPSPlus gps{stream};
+    TinyGPSRateControl rate{gps};
+    uint32_t second{0};
+};
+TEST_F(TestTinyGpsRateControl, rampsUpAtOnceAndDownAfterHold)
+{
+    EXPECT_FALSE(rate.isValid());
+    EXPECT_FALSE(rate.addLevel(100, 1000)); // out of order
+    drive(0, 0, 3);
+    EXPECT_EQ(0, rate.level());
+    EXPECT_EQ(5000, rate.periodMs());
+    drive(30);
+    EXPECT_EQ(2, rate.level());
+    EXPECT_EQ((std::vector<uint16_t>{5000, 200}), periods());
+
+    drive(0, 90, 5);
+    EXPECT_EQ(2, rate.level());
+    drive(0, 90, 6);
+    EXPECT_EQ(0, rate.level());
+    EXPECT_EQ((std::vector<uint16_t>{5000, 200, 5000}), periods());
+}
+TEST_F(TestTinyGpsRateControl, holdTimedAcrossMidnight)
+{
+    second = 12 * 3600 - 5; // 23:59:55
+    drive(30);
+    EXPECT_EQ(2, rate.level());
+    drive(0, 90, 10);
+    EXPECT_EQ(2, rate.level());
+    drive(0);
+    EXPECT_EQ(0, rate.level());
+}
+TEST_F(TestTinyGpsRateControl, hysteresisStopsFlapping)
+{
+    drive(4);
+    EXPECT_EQ(1, rate.level());
+    // Around the 3 kn threshold, never below 2 kn
+    for (int i = 0; i < 30; ++i)
+    {
+        drive(i % 2 ? 2.5 : 3.2);
+    }
+    EXPECT_EQ(1, rate.level());
+    EXPECT_EQ(1u, rate.switches()); // the first fix only
+}
+TEST_F(TestTinyGpsRateControl, turnRaisesRate)
+{
+    drive(5, 90, 3);
+    EXPECT_EQ(1, rate.level());
+    drive(5, 120); // 30 degrees in a second
+    EXPECT_EQ(2, rate.level());
+}
+TEST_F(TestTinyGpsRateControl, slowTurnAfterOutage)
+{
+    drive(5, 90, 3);
+    second += 2863; // a 2864 s gap: 1500 * 2864000 ms wraps 32 bits to 1032704
+    drive(5, 110);
+    EXPECT_EQ(1, rate.level());
+}
+TEST_F(TestTinyGpsRateControl, approachingGeofenceRaisesRate)
+{
+    // ~330 m north of the track
+    EXPECT_TRUE(rate.addGeofence(650787000, 254861000, 150, 2));
+    encode(rmc(second, 0, 0, 65.0757));
+    EXPECT_EQ(0, rate.level());
+    encode(rmc(second, 0, 0, 65.0770)); // ~190 m from the centre
+    EXPECT_EQ(2, rate.level());
+}
+TEST_F(TestTinyGpsRateControl, switchesThroughCommandQueue)
+{
+    TinyGPSPlus receiver{stream};
+    TinyGPSCommands commands{receiver, 9600};
+    TinyGPSRateControl queued{receiver, &commands};
+    EXPECT_TRUE(queued.addLevel(5000, 0));
+    EXPECT_TRUE(queued.addLevel(1000, 300));
+    const std::string s = rmc(0, 5, 0);
+    for (char c : s)
+    {
+        receiver.encode(c);
+    }
+    EXPECT_FALSE(commands.idle());
+    commands.poll();
+    for (uint8_t b : ackRate)
+    {
+        receiver.encode((char)b);
+    }
+    EXPECT_TRUE(commands.idle());
+    EXPECT_EQ(1000, queued.periodMs());
+}
+TEST_F(TestTinyGpsRateControl, parserOutlivesController)
+{
+    TinyGPSPlus receiver{stream};
+    {
+        TinyGPSRateControl scoped{receiver};
+        EXPECT_TRUE(scoped.addLevel(5000, 0));
+        EXPECT_TRUE(scoped.addLevel(1000, 300));
+    }
+    const std::string s = rmc(0, 5, 0);
+    for (char c : s)
+    {
+        receiver.encode(c);
+    }
+    EXPECT_EQ(1u, receiver.passedChecksum());
+    EXPECT_EQ(0u, stream.written());
+}
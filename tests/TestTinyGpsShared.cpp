@@ -0,0 +1,103 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSShared.h"
+#include <thread>
+#include <atomic>
+
+class TestTinyGpsShared : public ::testing::Test
+{
+protected:
+    void encode(const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+    }
+    TinyGPSPlus gps;
+    TinyGPSShared shared;
+};
+TEST_F(TestTinyGpsShared, noCommitsNothingValid)
+{
+    gps.addListener(&shared);
+    TinyGPSReader reader{shared};
+    const TinyGPSSnapshot& snap = reader.read();
+    EXPECT_FALSE(snap.isValid(TinyGPSSnapshot::LOCATION));
+    EXPECT_FALSE(reader.isUpdated(TinyGPSSnapshot::LOCATION));
+    EXPECT_EQ(0, shared.sequence());
+}
+TEST_F(TestTinyGpsShared, rmcPublishesLocationDateTime)
+{
+    gps.addListener(&shared);
+    encode("$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n");
+    TinyGPSReader reader{shared};
+    const TinyGPSSnapshot& snap = reader.read();
+    EXPECT_TRUE(snap.isValid(TinyGPSSnapshot::LOCATION));
+    EXPECT_TRUE(snap.isValid(TinyGPSSnapshot::DATE));
+    EXPECT_TRUE(snap.isValid(TinyGPSSnapshot::TIME));
+    EXPECT_FALSE(snap.isValid(TinyGPSSnapshot::ALTITUDE));
+    EXPECT_NEAR(65.0761608, snap.lat(), 1e-6);
+    EXPECT_NEAR(25.486113, snap.lng(), 1e-6);
+    EXPECT_EQ(81019, snap.date);
+    EXPECT_EQ(17562800, snap.time);
+    EXPECT_EQ(87, snap.speed); // 0.866 kn, rounded
+    EXPECT_EQ(2, shared.sequence());
+}
+TEST_F(TestTinyGpsShared, readersTrackUpdatesIndependently)
+{
+    gps.addListener(&shared);
+    TinyGPSReader first{shared};
+    TinyGPSReader second{shared};
+    encode("$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n");
+    first.read();
+    second.read();
+    EXPECT_TRUE(first.isUpdated(TinyGPSSnapshot::SATELLITES));
+    first.acknowledgeAll();
+    EXPECT_FALSE(first.isUpdated(TinyGPSSnapshot::SATELLITES));
+    EXPECT_TRUE(second.isUpdated(TinyGPSSnapshot::SATELLITES));
+    EXPECT_EQ(5, second.snapshot().satellites);
+    // Reading does not touch the parser-side flags
+    EXPECT_TRUE(gps.satellites.isUpdated());
+}
+TEST_F(TestTinyGpsShared, gsaSatelliteIdsPublished)
+{
+    gps.addListener(&shared);
+    encode("$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\n");
+    TinyGPSReader reader{shared};
+    const TinyGPSSnapshot& snap = reader.read();
+    ASSERT_EQ(7, snap.gsaNumSats);
+    EXPECT_EQ(30, snap.gsaSatIds[0]);
+    EXPECT_EQ(13, snap.gsaSatIds[6]);
+    EXPECT_EQ(0, snap.gsaSatIds[7]);
+}
+TEST_F(TestTinyGpsShared, concurrentReadersSeeConsistentSnapshots)
+{
+    gps.addListener(&shared);
+    const std::string a{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"};
+    const std::string b{"$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n"};
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+    auto readerLoop = [&]()
+    {
+        TinyGPSReader reader{shared};
+        while (!done.load())
+        {
+            const TinyGPSSnapshot& snap = reader.read();
+            if (!snap.isValid(TinyGPSSnapshot::TIME)) continue;
+            const bool isA = snap.time == 12253100 && snap.satellites == 8 && snap.altitude == 1580;
+            const bool isB = snap.time == 17562800 && snap.satellites == 5 && snap.altitude == 11730;
+            if (!isA && !isB) inconsistent++;
+        }
+    };
+    std::thread r1{readerLoop};
+    std::thread r2{readerLoop};
+    for (int i = 0; i < 2000; i++)
+    {
+        encode(i % 2 ? a : b);
+    }
+    done = true;
+    r1.join();
+    r2.join();
+    EXPECT_EQ(0, inconsistent.load());
+    EXPECT_EQ(4000, shared.sequence());
+}
@@ -0,0 +1,84 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPS++.h"
+#include "TinyGPSFdStream.h"
+#include <unistd.h>
+
+namespace
+{
+const std::string rmcAndGga{
+    "$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"
+    "$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"};
+}
+
+TEST(TestTinyGpsStream, memoryStreamGivesStatusPerSentence)
+{
+    TinyGPSMemoryStream stream{(const uint8_t*)rmcAndGga.data(), rmcAndGga.size()};
+    TinyGPSPlus gps{stream};
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::RMC, gps.readSerialGiveStatus());
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::GGA, gps.readSerialGiveStatus());
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::UNFINISHED, gps.readSerialGiveStatus());
+    EXPECT_EQ(rmcAndGga.size(), gps.charsProcessed());
+    EXPECT_EQ(0, stream.remaining());
+}
+TEST(TestTinyGpsStream, readSerialDrainsStream)
+{
+    TinyGPSMemoryStream stream{(const uint8_t*)rmcAndGga.data(), rmcAndGga.size()};
+    TinyGPSPlus gps{stream};
+    EXPECT_TRUE(gps.readSerial());
+    EXPECT_EQ(2, gps.passedChecksum());
+    EXPECT_EQ(8, gps.satellites.value());
+    EXPECT_FALSE(gps.readSerial());
+}
+TEST(TestTinyGpsStream, arrivalIsTheReadTime)
+{
+    TinyGPSMemoryStream stream{(const uint8_t*)rmcAndGga.data(), rmcAndGga.size()};
+    TinyGPSPlus gps{stream};
+    ASSERT_EQ(TinyGPSPlus::EncodeStatus::RMC, gps.readSerialGiveStatus());
+    const uint32_t read = gps.timestamp.arrival();
+    delay(20);
+    // The GGA came in the same read; parsing it later does not move its arrival
+    ASSERT_EQ(TinyGPSPlus::EncodeStatus::GGA, gps.readSerialGiveStatus());
+    EXPECT_EQ(read, gps.timestamp.arrival());
+}
+TEST(TestTinyGpsStream, sentenceTakesTheReadTimeOfItsStart)
+{
+    TinyGPSPlus gps;
+    size_t consumed = 0;
+    gps.encodeGiveStatus(rmcAndGga.data(), 20, consumed, 1000);
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::RMC, gps.encodeGiveStatus(rmcAndGga.data() + 20, rmcAndGga.size() - 20, consumed, 1500));
+    EXPECT_EQ(1000u, gps.timestamp.arrival());
+    const size_t gga = 20 + consumed;
+    EXPECT_EQ(TinyGPSPlus::EncodeStatus::GGA, gps.encodeGiveStatus(rmcAndGga.data() + gga, rmcAndGga.size() - gga, consumed, 1500));
+    EXPECT_EQ(1500u, gps.timestamp.arrival());
+}
+TEST(TestTinyGpsStream, sentencesGoToOwnStream)
+{
+    uint8_t out[64]{};
+    TinyGPSMemoryStream stream{nullptr, 0, out, sizeof(out)};
+    TinyGPSPlus gps{stream};
+    gps.switchOffGsv();
+    EXPECT_EQ(std::string("$PUBX,40,GSV,0,0,0,0,0,0*59\r\n"), std::string((const char*)out, stream.written()));
+}
+TEST(TestTinyGpsStream, baudrateChangeAppliedToStream)
+{
+    uint8_t out[64]{};
+    TinyGPSMemoryStream stream{nullptr, 0, out, sizeof(out)};
+    TinyGPSPlus gps{stream};
+    gps.baudrateTo115200();
+    EXPECT_EQ(115200, stream.baud());
+    EXPECT_EQ(std::string("$PUBX,41,1,0007,0003,115200,0*18\r\n"), std::string((const char*)out, stream.written()));
+}
+TEST(TestTinyGpsStream, fdStreamReadsPipe)
+{
+    int fds[2];
+    ASSERT_EQ(0, pipe(fds));
+    TinyGPSFdStream stream{fds[0]};
+    TinyGPSPlus gps{stream};
+    TinyGPSFdStream writer{fds[1]};
+    EXPECT_EQ(rmcAndGga.size(), writer.write((const uint8_t*)rmcAndGga.data(), rmcAndGga.size()));
+    close(fds[1]);
+    EXPECT_TRUE(gps.readSerial());
+    EXPECT_EQ(2, gps.passedChecksum());
+    close(fds[0]);
+}
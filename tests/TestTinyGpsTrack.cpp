@@ -0,0 +1,115 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSTrack.h"
+
+namespace
+{
+// ~1.11 m per 100 units of latitude
+const int32_t LAT{650000000};
+const int32_t LNG{250000000};
+}
+
+class TestTinyGpsTrack : public ::testing::Test
+{
+public:
+    TestTinyGpsTrack()
+    : track{storage, sizeof(storage) / sizeof(storage[0]), 5}
+    {}
+protected:
+    TinyGPSTrackPoint storage[8];
+    TinyGPSTrack track;
+};
+TEST_F(TestTinyGpsTrack, straightLineKeepsEndpoints)
+{
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        track.add(LAT + i * 1000, LNG, i);
+    }
+    ASSERT_EQ(2, track.size());
+    EXPECT_EQ(LAT, track[0].lat);
+    EXPECT_EQ(LAT + 9000, track[1].lat);
+    EXPECT_EQ(9, track[1].time);
+}
+TEST_F(TestTinyGpsTrack, cornerRetained)
+{
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        track.add(LAT + i * 1000, LNG, i);
+    }
+    for (uint32_t i = 1; i < 5; i++)
+    {
+        track.add(LAT + 4000, LNG + i * 2000, 4 + i);
+    }
+    ASSERT_EQ(3, track.size());
+    EXPECT_EQ(LAT + 4000, track[1].lat);
+    EXPECT_EQ(LNG, track[1].lng);
+    EXPECT_EQ(LNG + 8000, track[2].lng);
+}
+TEST_F(TestTinyGpsTrack, jitterWithinToleranceDropped)
+{
+    track.add(LAT, LNG, 0);
+    for (uint32_t i = 1; i < 10; i++)
+    {
+        track.add(LAT + (i % 2) * 100, LNG + (i % 3) * 100, i);
+    }
+    EXPECT_EQ(2, track.size());
+}
+TEST_F(TestTinyGpsTrack, capacityBoundedOldestOverwritten)
+{
+    // zig-zag so that every point is retained
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        track.add(LAT + i * 10000, LNG + (i % 2) * 10000, i);
+    }
+    ASSERT_EQ(8, track.size());
+    EXPECT_EQ(12, track[0].time);
+    EXPECT_EQ(19, track[7].time);
+    track.consume(5);
+    ASSERT_EQ(3, track.size());
+    EXPECT_EQ(17, track[0].time);
+}
+TEST_F(TestTinyGpsTrack, fedFromLocationCommits)
+{
+    TinyGPSPlus gps;
+    gps.addListener(&track);
+    std::string s1{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    std::string s2{"$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"};
+    for (char c : s1 + s2)
+    {
+        gps.encode(c);
+    }
+    ASSERT_EQ(1, track.size());
+    EXPECT_EQ(650757245, track[0].lat);
+    EXPECT_EQ(254865483, track[0].lng);
+    EXPECT_EQ(12253100, track[0].time);
+}
+TEST_F(TestTinyGpsTrack, untimedFixesAllKept)
+{
+    TinyGPSPlus gps;
+    gps.addListener(&track);
+    gps.enableLazyDecoding(1u << TinyGPSSnapshot::LOCATION);
+    std::string s1{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    std::string s2{"$GPRMC,122532.00,A,6504.64347,N,02529.19290,E,0.398,,251220,,,A*7B\n"};
+    for (char c : s1 + s2)
+    {
+        gps.encode(c);
+    }
+    EXPECT_FALSE(gps.time.isValid());
+    ASSERT_EQ(2, track.size());
+    EXPECT_EQ(650773912, track[1].lat);
+}
+TEST_F(TestTinyGpsTrack, straightLineAcrossAntimeridian)
+{
+    for (int64_t i = 0; i < 10; ++i)
+    {
+        int64_t lng = 1799995000LL + i * 1000;
+        if (lng > 1800000000LL)
+        {
+            lng -= 3600000000LL;
+        }
+        track.add(LAT, (int32_t)lng, (uint32_t)i);
+    }
+    ASSERT_EQ(2, track.size());
+    EXPECT_EQ(1799995000, track[0].lng);
+    EXPECT_EQ(-1799996000, track[1].lng);
+}
@@ -0,0 +1,85 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSTrig.h"
+#include <math.h>
+
+class TestTinyGpsTrig : public ::testing::Test
+{
+protected:
+    static double distanceLibm(double lat1, double lng1, double lat2, double lng2)
+    {
+        // TinyGPSPlus::distanceBetween() with libm, independent of _GPS_FAST_TRIG
+        const double r = M_PI / 180.0;
+        const double delta = (lng1 - lng2) * r;
+        lat1 *= r;
+        lat2 *= r;
+        const double a = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(delta);
+        const double b = cos(lat2) * sin(delta);
+        const double denom = sin(lat1) * sin(lat2) + cos(lat1) * cos(lat2) * cos(delta);
+        return atan2(sqrt(a * a + b * b), denom) * 6372795;
+    }
+    static double courseLibm(double lat1, double lng1, double lat2, double lng2)
+    {
+        const double r = M_PI / 180.0;
+        const double dlon = (lng2 - lng1) * r;
+        lat1 *= r;
+        lat2 *= r;
+        double c = atan2(sin(dlon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dlon));
+        if (c < 0.0) c += 2 * M_PI;
+        return c / r;
+    }
+};
+TEST_F(TestTinyGpsTrig, sinCosAgainstLibm)
+{
+    double maxSin = 0.0, maxCos = 0.0;
+    for (double x = -2 * M_PI; x <= 2 * M_PI; x += 0.0001)
+    {
+        maxSin = std::max(maxSin, fabs(TinyGPSTrig::sin(x) - sin(x)));
+        maxCos = std::max(maxCos, fabs(TinyGPSTrig::cos(x) - cos(x)));
+    }
+    std::cout << "max sin error " << maxSin << ", max cos error " << maxCos << std::endl;
+    EXPECT_LT(maxSin, 3e-7);
+    EXPECT_LT(maxCos, 3e-7);
+}
+TEST_F(TestTinyGpsTrig, atan2AgainstLibm)
+{
+    double maxErr = 0.0;
+    for (double a = -M_PI; a < M_PI; a += 0.0001)
+    {
+        for (double r : {1e-3, 1.0, 1e3})
+        {
+            const double y = r * sin(a), x = r * cos(a);
+            maxErr = std::max(maxErr, fabs((double)TinyGPSTrig::atan2(y, x) - atan2(y, x)));
+        }
+    }
+    std::cout << "max atan2 error " << maxErr << " rad" << std::endl;
+    EXPECT_LT(maxErr, 4e-7);
+    EXPECT_EQ(0.0f, TinyGPSTrig::atan2(0.0f, 0.0f));
+}
+TEST_F(TestTinyGpsTrig, distanceAndCourseAgainstLibm)
+{
+    double maxDistErr = 0.0, maxInputErr = 0.0, maxCourseErr = 0.0;
+    for (int i = 0; i < 2000; i++)
+    {
+        const double lat1 = -80.0 + (i * 37 % 160), lng1 = -170.0 + (i * 53 % 340) + 0.123;
+        const double scale = pow(10.0, (i % 7) - 3); // 0.001 .. 1000 deg
+        const double lat2 = std::max(-89.0, std::min(89.0, lat1 + 0.7 * scale)), lng2 = lng1 + 0.4 * scale;
+        // The kernels see the inputs as float; rounding them is measured apart
+        const double expected = distanceLibm((float)lat1, (float)lng1, (float)lat2, (float)lng2);
+        const double err = fabs(TinyGPSTrig::distanceBetween(lat1, lng1, lat2, lng2) - expected);
+        EXPECT_LT(err, 2.5 + 2e-6 * expected) << lat1 << "," << lng1 << " -> " << lat2 << "," << lng2;
+        maxDistErr = std::max(maxDistErr, err);
+        const double inputErr = fabs(distanceLibm(lat1, lng1, lat2, lng2) - expected);
+        EXPECT_LT(inputErr, 0.5 + 2e-6 * expected);
+        maxInputErr = std::max(maxInputErr, inputErr);
+        if (expected > 1000.0)
+        {
+            double courseErr = fabs(TinyGPSTrig::courseTo(lat1, lng1, lat2, lng2) - courseLibm(lat1, lng1, lat2, lng2));
+            courseErr = std::min(courseErr, 360.0 - courseErr);
+            EXPECT_LT(courseErr, 0.01);
+            maxCourseErr = std::max(maxCourseErr, courseErr);
+        }
+    }
+    std::cout << "max distance error " << maxDistErr << " m (float inputs " << maxInputErr << " m), max course error "
+              << maxCourseErr << " deg" << std::endl;
+}
@@ -0,0 +1,124 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSTrip.h"
+#include <stdio.h>
+
+namespace
+{
+// GGA at 'second' after 12:00:00
+std::string gga(uint32_t second, double lat, double lng)
+{
+    char body[128];
+    const int latDeg = (int)lat, lngDeg = (int)lng;
+    snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,%02d%08.5f,N,%03d%08.5f,E,1,08,1.00,15.8,M,21.0,M,,",
+             12 + second / 3600, second / 60 % 60, second % 60,
+             latDeg, (lat - latDeg) * 60, lngDeg, (lng - lngDeg) * 60);
+    uint8_t parity = 0;
+    for (const char* p = body; *p; ++p)
+    {
+        parity ^= (uint8_t)*p;
+    }
+    char sentence[160];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X\r\n", body, parity);
+    return sentence;
+}
+}
+
+class TestTinyGpsTrip : public ::testing::Test
+{
+protected:
+    TinyGPSTrip trip;
+};
+TEST_F(TestTinyGpsTrip, shortHopsMatchExactDistance)
+{
+    double lat = 65.0757;
+    const double lng = 25.4865;
+    double expected = 0.0;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        trip.add(lat, lng + i * 0.0002, 12000000 + i * 10, 1000, 100);
+        if (i > 0)
+        {
+            expected += TinyGPSPlus::distanceBetween(lat, lng + (i - 1) * 0.0002, lat, lng + i * 0.0002);
+        }
+    }
+    EXPECT_NEAR(expected, trip.distanceMeters(), expected * 1e-4);
+    EXPECT_EQ(9, trip.movingSeconds());
+    EXPECT_EQ(9, trip.elapsedSeconds());
+    EXPECT_NEAR(18.52, trip.maxSpeedKmph(), 1e-9);
+}
+TEST_F(TestTinyGpsTrip, longGapUsesExactFormula)
+{
+    trip.add(60.0, 25.0, 12000000, 1000, 100);
+    trip.add(61.0, 25.0, 12100000, 1000, 100);
+    EXPECT_DOUBLE_EQ(TinyGPSPlus::distanceBetween(60.0, 25.0, 61.0, 25.0), trip.distanceMeters());
+    EXPECT_EQ(600, trip.elapsedSeconds());
+}
+TEST_F(TestTinyGpsTrip, stationaryJitterRejected)
+{
+    trip.add(65.0, 25.0, 12000000, 0, 200);
+    for (uint32_t i = 1; i < 20; i++)
+    {
+        // ~2 m back and forth, hdop 2.0 allows 10 m
+        trip.add(65.0 + (i % 2) * 0.00002, 25.0, 12000000 + i * 100, 10, 200);
+    }
+    EXPECT_DOUBLE_EQ(0.0, trip.distanceMeters());
+    EXPECT_EQ(19, trip.rejectedHops());
+    EXPECT_EQ(0, trip.movingSeconds());
+    EXPECT_EQ(19, trip.elapsedSeconds());
+}
+TEST_F(TestTinyGpsTrip, slowDriftAccumulatesPastJitter)
+{
+    trip.add(65.0, 25.0, 12000000, 0, 100);
+    for (uint32_t i = 1; i <= 10; i++)
+    {
+        // 1.1 m per step, jitter limit 5 m
+        trip.add(65.0 + i * 0.00001, 25.0, 12000000 + i * 100, 0, 100);
+    }
+    EXPECT_NEAR(TinyGPSPlus::distanceBetween(65.0, 25.0, 65.0001, 25.0), trip.distanceMeters(), 0.01);
+}
+TEST_F(TestTinyGpsTrip, midnightWrap)
+{
+    trip.add(65.0, 25.0, 23595900, 1000, 100);
+    trip.add(65.0001, 25.0, 100, 1000, 100);
+    EXPECT_EQ(2, trip.elapsedSeconds());
+}
+TEST_F(TestTinyGpsTrip, fedFromCommits)
+{
+    TinyGPSPlus gps;
+    gps.addListener(&trip);
+    std::string s{"$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n"
+                  "$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n"
+                  "$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n"};
+    for (char c : s)
+    {
+        gps.encode(c);
+    }
+    EXPECT_NEAR(TinyGPSPlus::distanceBetween(65.0757245, 25.4865483, 65.0761608, 25.4861133),
+                trip.distanceMeters(), 0.05);
+    EXPECT_NEAR(0.866 * 1.852, trip.maxSpeedKmph(), 0.02);
+}
+TEST_F(TestTinyGpsTrip, ggaOnlyMovementFromDisplacement)
+{
+    TinyGPSPlus gps;
+    gps.addListener(&trip);
+    // Parked for 20 s with 1 m of noise, then 60 s north at 10 m/s
+    std::string s;
+    for (uint32_t t = 0; t < 20; ++t)
+    {
+        s += gga(t, 65.0 + (t % 2) * 0.000009, 25.0);
+    }
+    for (uint32_t t = 20; t <= 80; ++t)
+    {
+        s += gga(t, 65.0 + (t - 19) * 0.0000899, 25.0);
+    }
+    for (char c : s)
+    {
+        gps.encode(c);
+    }
+    EXPECT_EQ(80u, trip.elapsedSeconds());
+    EXPECT_EQ(61u, trip.movingSeconds());
+    EXPECT_NEAR(610, trip.distanceMeters(), 5);
+    EXPECT_NEAR(36, trip.averageMovingKmph(), 1);
+    EXPECT_NEAR(36, trip.maxSpeedKmph(), 1);
+}
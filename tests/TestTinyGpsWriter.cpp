@@ -0,0 +1,88 @@
+
+#include "gtest/gtest.h"
+#include "TinyGPSWriter.h"
+
+class TestTinyGpsWriter : public ::testing::Test
+{
+public:
+    TestTinyGpsWriter()
+    : writer{buffer, sizeof(buffer)}
+    {}
+protected:
+    void encode(const std::string& s)
+    {
+        for (char c : s)
+        {
+            gps.encode(c);
+        }
+    }
+    TinyGPSPlus gps;
+    char buffer[512];
+    TinyGPSWriter writer;
+};
+TEST_F(TestTinyGpsWriter, rmcRoundTrip)
+{
+    encode("$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n");
+    EXPECT_TRUE(writer.rmc(gps));
+    EXPECT_STREQ("$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.40,0.00,251220,,,A*53\r\n", writer.c_str());
+    TinyGPSPlus reparsed;
+    for (size_t i = 0; i < writer.length(); i++)
+    {
+        reparsed.encode(writer.c_str()[i]);
+    }
+    EXPECT_EQ(1, reparsed.passedChecksum());
+    EXPECT_EQ(gps.location.rawLat().billionths, reparsed.location.rawLat().billionths);
+    EXPECT_EQ(gps.location.rawLng().billionths, reparsed.location.rawLng().billionths);
+}
+TEST_F(TestTinyGpsWriter, ggaSouthWest)
+{
+    encode("$GPGGA,175628.00,6504.56965,S,02529.16680,W,1,05,3.69,117.3,M,21.0,M,,*59\n");
+    EXPECT_TRUE(writer.gga(gps));
+    TinyGPSPlus reparsed;
+    for (size_t i = 0; i < writer.length(); i++)
+    {
+        reparsed.encode(writer.c_str()[i]);
+    }
+    EXPECT_EQ(1, reparsed.passedChecksum());
+    EXPECT_DOUBLE_EQ(gps.location.lat(), reparsed.location.lat());
+    EXPECT_DOUBLE_EQ(gps.location.lng(), reparsed.location.lng());
+    EXPECT_EQ(5, reparsed.satellites.value());
+    EXPECT_EQ(11730, reparsed.altitude.value());
+}
+TEST_F(TestTinyGpsWriter, gsaAndGsv)
+{
+    encode("$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\n");
+    encode("$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n");
+    EXPECT_TRUE(writer.gsa(gps.gsa));
+    EXPECT_TRUE(writer.gsv(gps.satsInView));
+    EXPECT_STREQ("$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\r\n"
+                 "$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\r\n", writer.c_str());
+}
+TEST_F(TestTinyGpsWriter, jsonAndCsv)
+{
+    encode("$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n");
+    EXPECT_TRUE(writer.json(gps));
+    EXPECT_STREQ("{\"time\":\"2020-12-25T12:25:31.00Z\",\"lat\":65.075724500,\"lng\":25.486548333,"
+                 "\"speed\":0.40,\"course\":0.00,\"alt\":null,\"sats\":null,\"hdop\":null,\"fix\":\"N/A\"}\n", writer.c_str());
+    writer.clear();
+    EXPECT_TRUE(writer.csv(gps));
+    EXPECT_STREQ("2020-12-25T12:25:31.00Z,65.075724500,25.486548333,0.40,0.00,,,,N/A\n", writer.c_str());
+}
+TEST_F(TestTinyGpsWriter, overflowReported)
+{
+    char small[16];
+    TinyGPSWriter tiny{small, sizeof(small)};
+    encode("$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n");
+    EXPECT_FALSE(tiny.rmc(gps));
+    EXPECT_TRUE(tiny.overflowed());
+    EXPECT_EQ(15, tiny.length());
+    tiny.clear();
+    EXPECT_FALSE(tiny.overflowed());
+}
+TEST_F(TestTinyGpsWriter, fixedNegative)
+{
+    writer.fixed(-1234, 2);
+    writer.put(',');
+    writer.fixed(-5, 2);
+    EXPECT_STREQ("-12.34,-0.05", writer.c_str());
+}
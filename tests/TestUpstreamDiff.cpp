@@ -0,0 +1,364 @@
+// Differential tests against upstream TinyGPSPlus: the same corpora go
+// to both parsers, which must agree on the fields they share and on the
+// checksum counters. Built only with TINYGPS_UPSTREAM.
+#ifdef TINYGPS_UPSTREAM
+#include "gtest/gtest.h"
+#include "TinyGPS++.h"
+#include "UpstreamParser.h"
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+int64_t billionths(const RawDegrees& deg)
+{
+    const int64_t value = (int64_t)deg.deg * 1000000000 + deg.billionths;
+    return deg.negative ? -value : value;
+}
+
+// Ours, in the units of upstream
+ParserState stateOf(const TinyGPSPlus& gps)
+{
+    ParserState s;
+    s.valid[ParserState::LAT] = s.valid[ParserState::LNG] = gps.location.isValid();
+    s.value[ParserState::LAT] = billionths(gps.location.peekLat());
+    s.value[ParserState::LNG] = billionths(gps.location.peekLng());
+    s.valid[ParserState::DATE] = gps.date.isValid();
+    s.value[ParserState::DATE] = gps.date.peek();
+    s.valid[ParserState::TIME] = gps.time.isValid();
+    s.value[ParserState::TIME] = gps.time.peek();
+    s.valid[ParserState::SPEED] = gps.speed.isValid();
+    s.value[ParserState::SPEED] = TinyGPSPlus::rescale(gps.speed.peek(), TinyGPSSpeed::decimals, 2);
+    s.valid[ParserState::COURSE] = gps.course.isValid();
+    s.value[ParserState::COURSE] = TinyGPSPlus::rescale(gps.course.peek(), TinyGPSCourse::decimals, 2);
+    s.valid[ParserState::ALTITUDE] = gps.altitude.isValid();
+    s.value[ParserState::ALTITUDE] = TinyGPSPlus::rescale(gps.altitude.peek(), TinyGPSAltitude::decimals, 2);
+    s.valid[ParserState::SATELLITES] = gps.satellites.isValid();
+    s.value[ParserState::SATELLITES] = gps.satellites.peek();
+    s.valid[ParserState::HDOP] = gps.hdop.isValid();
+    s.value[ParserState::HDOP] = TinyGPSPlus::rescale(gps.hdop.peek(), TinyGPSHDOP::decimals, 2);
+    s.passedChecksum = gps.passedChecksum();
+    s.failedChecksum = gps.failedChecksum();
+    s.sentencesWithFix = gps.sentencesWithFix();
+    return s;
+}
+
+const char* const fieldNames[ParserState::FIELD_COUNT] = {
+    "lat", "lng", "date", "time", "speed", "course", "altitude", "satellites", "hdop"
+};
+
+// Upstream truncates decimal terms, ours rounds them
+bool rounds(int field)
+{
+    return field == ParserState::SPEED || field == ParserState::COURSE ||
+           field == ParserState::ALTITUDE || field == ParserState::HDOP;
+}
+
+std::string sentence(const std::string& body)
+{
+    uint8_t parity = 0;
+    for (char c : body)
+    {
+        parity ^= (uint8_t)c;
+    }
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", parity);
+    return "$" + body + tail;
+}
+
+// A Neo6M, from the captures in TestTinyGpsPlus
+const std::vector<std::string> neo6m = {
+    "$GPRMC,175404.00,V,,,,,,,081019,,,N*7F\n",
+    "$GPGGA,175405.00,,,,,0,00,99.99,,,,,,*64\n",
+    "$GPGSA,A,1,,,,,,,,,,,,,99.99,99.99,99.99*30\n",
+    "$GPVTG,,,,,,,,,N*30\n",
+    "$GPRMC,175628.00,A,6504.56965,N,02529.16680,E,0.866,,081019,,,A*7D\n",
+    "$GPVTG,,T,,M,0.866,N,1.605,K,A*29\n",
+    "$GPGGA,175628.00,6504.56965,N,02529.16680,E,1,05,3.69,117.3,M,21.0,M,,*56\n",
+    "$GPGSA,,2,30,21,07,27,,,,,,,,,37.86,17.72,33.45*78\n",
+    "$GPGSV,3,1,09,05,45,242,14,07,57,095,33,08,21,080,31,09,12,126,13*72\n",
+    "$GPGSV,3,2,09,13,39,278,27,15,09,295,,21,18,341,29,27,24,040,26*76\n",
+    "$GPGSV,3,3,09,30,71,180,22*4C\n",
+    "$GPRMC,122531.00,A,6504.54347,N,02529.19290,E,0.398,,251220,,,A*7B\n",
+    "$GPGGA,122531.00,6504.54347,N,02529.19290,E,1,08,2.50,15.8,M,21.0,M,,*63\n",
+    "$GPGSA,A,3,30,08,21,07,05,27,13,,,,,,3.45,1.67,3.02*0C\n",
+    "$GPGSV,1,1,04,07,,,31,17,,,20,21,,,31,27,,,35*7E\n",
+};
+
+// Epochs of RMC, GGA, GSA, GSV, VTG and GLL from a receiver wandering
+// over the globe, with fixes coming and going, empty terms and more
+// decimals than the fields keep. Upstream commits an empty term with
+// whatever the last sentence staged, even one that failed its checksum,
+// so corrupted streams are built without empty courses.
+std::vector<std::string> synthetic(unsigned epochs, unsigned seed, bool emptyCourses = true)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0, 1);
+    std::vector<std::string> lines;
+    char body[160];
+    double lat = 65.076, lng = 25.486;
+    for (unsigned i = 0; i < epochs; ++i)
+    {
+        lat += (unit(rng) - 0.5) * 0.01;
+        lng += (unit(rng) - 0.5) * 0.01;
+        if (unit(rng) < 0.01)
+        {
+            lat = unit(rng) * 180 - 90;
+            lng = unit(rng) * 360 - 180;
+        }
+        lat = lat > 89.9 ? 89.9 : lat < -89.9 ? -89.9 : lat;
+        lng = lng > 179.9 ? lng - 359 : lng < -179.9 ? lng + 359 : lng;
+        const bool fix = unit(rng) < 0.9;
+        const unsigned second = i % 86400;
+        char hhmmss[16], date[8], latTerm[24], lngTerm[24], speed[16], course[16], altitude[16];
+        snprintf(hhmmss, sizeof(hhmmss), "%02u%02u%02u.%02u", second / 3600, second / 60 % 60, second % 60,
+                 (unsigned)(unit(rng) * 100));
+        snprintf(date, sizeof(date), "%02u%02u%02u", 1 + i / 86400 % 28, 1 + i / 86400 / 28 % 12, 24 + i / 86400 / 336);
+        const double alat = lat < 0 ? -lat : lat, alng = lng < 0 ? -lng : lng;
+        snprintf(latTerm, sizeof(latTerm), "%02d%0*.*f,%c", (int)alat, 6 + (int)(i % 3),
+                 3 + (int)(i % 3), (alat - (int)alat) * 60, lat < 0 ? 'S' : 'N');
+        snprintf(lngTerm, sizeof(lngTerm), "%03d%0*.*f,%c", (int)alng, 7 + (int)(i % 3),
+                 4 + (int)(i % 3), (alng - (int)alng) * 60, lng < 0 ? 'W' : 'E');
+        snprintf(speed, sizeof(speed), "%.3f", unit(rng) * 120);
+        if (unit(rng) < 0.2 && emptyCourses)
+            course[0] = '\0';
+        else
+            snprintf(course, sizeof(course), "%.2f", unit(rng) * 360);
+        snprintf(altitude, sizeof(altitude), "%.1f", unit(rng) * 3000 - 100);
+        const unsigned satellites = fix ? 4 + (unsigned)(unit(rng) * 12) : 0;
+        const double hdop = fix ? 0.5 + unit(rng) * 5 : 99.99;
+
+        snprintf(body, sizeof(body), "GPRMC,%s,%c,%s,%s,%s,%s,%s,,,%c", hhmmss, fix ? 'A' : 'V',
+                 latTerm, lngTerm, speed, course, date, fix ? 'A' : 'N');
+        lines.push_back(sentence(body));
+        if (fix)
+            snprintf(body, sizeof(body), "GPGGA,%s,%s,%s,%u,%02u,%.3f,%s,M,21.0,M,,", hhmmss, latTerm, lngTerm,
+                     1 + i % 2, satellites, hdop, altitude);
+        else
+            snprintf(body, sizeof(body), "GPGGA,%s,,,,,0,00,99.99,,,,,,", hhmmss);
+        lines.push_back(sentence(body));
+        snprintf(body, sizeof(body), "GPGSA,A,%c,30,08,21,07,,,,,,,,,%.2f,%.2f,%.2f", fix ? '3' : '1',
+                 hdop * 1.3, hdop, hdop * 0.8);
+        lines.push_back(sentence(body));
+        if (i % 5 == 0)
+        {
+            lines.push_back(sentence("GPGSV,2,1,05,05,45,242,14,07,57,095,33,08,21,080,31,09,12,126,13"));
+            lines.push_back(sentence("GPGSV,2,2,05,13,39,278,27"));
+        }
+        snprintf(body, sizeof(body), "GPVTG,%s,T,,M,%s,N,%.3f,K,%c", course, speed, atof(speed) * 1.852,
+                 fix ? 'A' : 'N');
+        lines.push_back(sentence(body));
+        snprintf(body, sizeof(body), "GPGLL,%s,%s,%s,%c,%c", latTerm, lngTerm, hhmmss, fix ? 'A' : 'V',
+                 fix ? 'A' : 'N');
+        lines.push_back(sentence(body));
+    }
+    return lines;
+}
+
+// How a sentence of the corrupted corpus was damaged. Every damage is
+// inside the body, so each damaged sentence is one checksum failure for
+// upstream; ours drops the non-printable and overlong ones before the
+// checksum, as framing errors
+enum Damage
+{
+    INTACT,
+    FLIPPED_DIGIT,
+    DROPPED_CHAR,
+    NON_PRINTABLE,
+    OVERLONG_TERM,
+    MISSING_CHECKSUM,
+    TRUNCATED,
+    JUNK_AFTER,
+    DAMAGE_COUNT
+};
+
+struct Corrupted
+{
+    std::vector<std::string> lines;
+    unsigned count[DAMAGE_COUNT] = {};
+};
+
+Corrupted corrupt(const std::vector<std::string>& lines, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    Corrupted out;
+    for (const std::string& line : lines)
+    {
+        std::string s = line;
+        const size_t star = s.find('*');
+        const Damage damage = rng() % 4 ? INTACT : (Damage)(1 + rng() % (DAMAGE_COUNT - 1));
+        size_t pos = 1 + rng() % (star - 1); // in the body
+        switch (damage)
+        {
+        case INTACT:
+            break;
+        case FLIPPED_DIGIT:
+            while (!isdigit((unsigned char)s[pos]))
+                pos = 1 + rng() % (star - 1);
+            s[pos] = '0' + (s[pos] - '0' + 1 + rng() % 9) % 10;
+            break;
+        case DROPPED_CHAR:
+            while (!isdigit((unsigned char)s[pos]))
+                pos = 1 + rng() % (star - 1);
+            s.erase(pos, 1);
+            break;
+        case NON_PRINTABLE:
+            // Not CR or LF, which would split the sentence in two for
+            // upstream; other bytes go into its parity, so the sentence
+            // fails upstream's checksum
+            s.insert(pos, 1, "\x01\x02\x07\x08\x09\x0B\x0C\x1B\x7F"[rng() % 9]);
+            break;
+        case OVERLONG_TERM:
+            // Fifteen digits, XOR 0x38, at the end of the first term
+            s.insert(s.find(',', s.find(',') + 1), "123456781234567");
+            break;
+        case MISSING_CHECKSUM:
+            s.erase(star, 3);
+            break;
+        case TRUNCATED:
+            s.erase(pos);
+            break;
+        case JUNK_AFTER:
+            s += "garbage 12, from a reset\r\n";
+            break;
+        case DAMAGE_COUNT:
+            break;
+        }
+        ++out.count[damage];
+        out.lines.push_back(s);
+    }
+    return out;
+}
+
+struct Report
+{
+    unsigned comparisons = 0;
+    unsigned mismatches = 0;
+    unsigned roundingDifferences[ParserState::FIELD_COUNT] = {};
+};
+
+// Feeds both parsers line by line and compares them after each complete line
+Report compare(const std::vector<std::string>& lines, TinyGPSPlus& ours, UpstreamParser& upstream)
+{
+    Report report;
+    for (const std::string& line : lines)
+    {
+        for (char c : line)
+        {
+            ours.encode(c);
+            upstream.encode(c);
+        }
+        if (line.empty() || line[line.size() - 1] != '\n')
+            continue;
+        const ParserState a = stateOf(ours), b = upstream.state();
+        ++report.comparisons;
+        bool same = a.passedChecksum == b.passedChecksum && a.sentencesWithFix == b.sentencesWithFix;
+        for (int f = 0; f < ParserState::FIELD_COUNT; ++f)
+        {
+            if (a.valid[f] != b.valid[f])
+            {
+                same = false;
+                ADD_FAILURE() << fieldNames[f] << " validity differs after " << line;
+            }
+            else if (a.valid[f] && a.value[f] != b.value[f])
+            {
+                const int64_t d = a.value[f] - b.value[f];
+                if (rounds(f) && (d == 1 || d == -1))
+                {
+                    ++report.roundingDifferences[f];
+                }
+                else
+                {
+                    same = false;
+                    ADD_FAILURE() << fieldNames[f] << ": ours " << a.value[f] << ", upstream " << b.value[f]
+                                  << " after " << line;
+                }
+            }
+        }
+        EXPECT_EQ(b.passedChecksum, a.passedChecksum) << line;
+        EXPECT_EQ(b.sentencesWithFix, a.sentencesWithFix) << line;
+        report.mismatches += !same;
+        if (report.mismatches > 10)
+            break;
+    }
+    const ParserState a = stateOf(ours), b = upstream.state();
+    EXPECT_EQ(b.failedChecksum,
+              a.failedChecksum + ours.corruption.nonPrintable + ours.corruption.overlongTerm);
+    for (int f = 0; f < ParserState::FIELD_COUNT; ++f)
+        if (report.roundingDifferences[f])
+            printf("  %s: %u comparisons 1 apart in the last place (rounding)\n", fieldNames[f],
+                   report.roundingDifferences[f]);
+    return report;
+}
+
+template <class Parser>
+double megabytesPerSecond(const std::string& stream, unsigned repeats)
+{
+    Parser parser;
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned r = 0; r < repeats; ++r)
+        for (char c : stream)
+            parser.encode(c);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return stream.size() * (double)repeats / elapsed.count() / 1e6;
+}
+}
+
+TEST(UpstreamDiff, Neo6mCaptures)
+{
+    TinyGPSPlus ours;
+    UpstreamParser upstream;
+    const Report report = compare(neo6m, ours, upstream);
+    EXPECT_EQ(neo6m.size(), report.comparisons);
+    EXPECT_EQ(0u, report.mismatches);
+    EXPECT_EQ(neo6m.size(), ours.passedChecksum());
+}
+
+TEST(UpstreamDiff, SyntheticStream)
+{
+    TinyGPSPlus ours;
+    UpstreamParser upstream;
+    const std::vector<std::string> lines = synthetic(2000, 49);
+    const Report report = compare(lines, ours, upstream);
+    EXPECT_EQ(0u, report.mismatches);
+    EXPECT_EQ(lines.size(), ours.passedChecksum());
+    EXPECT_EQ(0u, ours.failedChecksum());
+    EXPECT_GT(ours.sentencesWithFix(), 0u);
+}
+
+TEST(UpstreamDiff, CorruptedStream)
+{
+    TinyGPSPlus ours;
+    UpstreamParser upstream;
+    const Corrupted corrupted = corrupt(synthetic(2000, 50, false), 51);
+    for (int d = FLIPPED_DIGIT; d < DAMAGE_COUNT; ++d)
+        ASSERT_GT(corrupted.count[d], 0u);
+    const Report report = compare(corrupted.lines, ours, upstream);
+    EXPECT_EQ(0u, report.mismatches);
+    EXPECT_EQ(corrupted.count[NON_PRINTABLE], ours.corruption.nonPrintable);
+    EXPECT_EQ(corrupted.count[OVERLONG_TERM], ours.corruption.overlongTerm);
+    EXPECT_EQ(corrupted.count[MISSING_CHECKSUM], ours.corruption.missingChecksum);
+    EXPECT_EQ(corrupted.count[TRUNCATED], ours.corruption.truncated);
+    EXPECT_EQ(corrupted.count[FLIPPED_DIGIT] + corrupted.count[DROPPED_CHAR], ours.failedChecksum());
+}
+
+// Reported, not asserted: the numbers depend on the host and the build
+TEST(UpstreamDiff, ThroughputAndSize)
+{
+    std::string stream;
+    for (const std::string& line : synthetic(500, 52))
+        stream += line;
+    const double oursRate = megabytesPerSecond<TinyGPSPlus>(stream, 20);
+    const double upstreamRate = megabytesPerSecond<UpstreamParser>(stream, 20);
+    printf("  upstream %s: %.1f MB/s, sizeof %zu\n", UpstreamParser::version(), upstreamRate,
+           UpstreamParser::parserSize());
+    printf("  ours %s: %.1f MB/s (%.2fx), sizeof %zu\n", TinyGPSPlus::libraryVersion(), oursRate,
+           oursRate / upstreamRate, sizeof(TinyGPSPlus));
+    EXPECT_GT(oursRate, 0);
+    EXPECT_GT(upstreamRate, 0);
+}
+#endif
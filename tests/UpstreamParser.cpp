@@ -0,0 +1,65 @@
+#ifdef TINYGPS_UPSTREAM
+// Upstream is compiled into this file with its classes renamed
+#define TinyGPSPlus UpstreamTinyGPSPlus
+#define TinyGPSLocation UpstreamTinyGPSLocation
+#define TinyGPSDate UpstreamTinyGPSDate
+#define TinyGPSTime UpstreamTinyGPSTime
+#define TinyGPSDecimal UpstreamTinyGPSDecimal
+#define TinyGPSInteger UpstreamTinyGPSInteger
+#define TinyGPSSpeed UpstreamTinyGPSSpeed
+#define TinyGPSCourse UpstreamTinyGPSCourse
+#define TinyGPSAltitude UpstreamTinyGPSAltitude
+#define TinyGPSHDOP UpstreamTinyGPSHDOP
+#define TinyGPSCustom UpstreamTinyGPSCustom
+#define RawDegrees UpstreamRawDegrees
+#include "../TinyGPSPlus/src/TinyGPS++.cpp"
+#include "UpstreamParser.h"
+
+namespace
+{
+int64_t billionths(const RawDegrees& deg)
+{
+    const int64_t value = (int64_t)deg.deg * 1000000000 + deg.billionths;
+    return deg.negative ? -value : value;
+}
+}
+
+struct UpstreamParser::Impl
+{
+    TinyGPSPlus gps;
+};
+
+UpstreamParser::UpstreamParser() : impl(new Impl) {}
+UpstreamParser::~UpstreamParser() { delete impl; }
+bool UpstreamParser::encode(char c) { return impl->gps.encode(c); }
+size_t UpstreamParser::parserSize() { return sizeof(TinyGPSPlus); }
+const char* UpstreamParser::version() { return _GPS_VERSION; }
+
+// The accessors clear isUpdated(), so a copy is read
+ParserState UpstreamParser::state() const
+{
+    TinyGPSPlus gps = impl->gps;
+    ParserState s;
+    s.valid[ParserState::LAT] = s.valid[ParserState::LNG] = gps.location.isValid();
+    s.value[ParserState::LAT] = billionths(gps.location.rawLat());
+    s.value[ParserState::LNG] = billionths(gps.location.rawLng());
+    s.valid[ParserState::DATE] = gps.date.isValid();
+    s.value[ParserState::DATE] = gps.date.value();
+    s.valid[ParserState::TIME] = gps.time.isValid();
+    s.value[ParserState::TIME] = gps.time.value();
+    s.valid[ParserState::SPEED] = gps.speed.isValid();
+    s.value[ParserState::SPEED] = gps.speed.value();
+    s.valid[ParserState::COURSE] = gps.course.isValid();
+    s.value[ParserState::COURSE] = gps.course.value();
+    s.valid[ParserState::ALTITUDE] = gps.altitude.isValid();
+    s.value[ParserState::ALTITUDE] = gps.altitude.value();
+    s.valid[ParserState::SATELLITES] = gps.satellites.isValid();
+    s.value[ParserState::SATELLITES] = gps.satellites.value();
+    s.valid[ParserState::HDOP] = gps.hdop.isValid();
+    s.value[ParserState::HDOP] = gps.hdop.value();
+    s.passedChecksum = gps.passedChecksum();
+    s.failedChecksum = gps.failedChecksum();
+    s.sentencesWithFix = gps.sentencesWithFix();
+    return s;
+}
+#endif
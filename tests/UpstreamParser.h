@@ -0,0 +1,43 @@
+// Upstream TinyGPSPlus (the TinyGPSPlus submodule) behind an interface that
+// does not include either library's headers: both define TinyGPSPlus and
+// use the same include guard. Built only with TINYGPS_UPSTREAM.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// The fields both libraries decode, in the units of upstream
+struct ParserState
+{
+    enum Field
+    {
+        LAT,        // signed billionths of a degree
+        LNG,
+        DATE,       // ddmmyy
+        TIME,       // hhmmsscc
+        SPEED,      // 0.01 knots
+        COURSE,     // 0.01 degrees
+        ALTITUDE,   // 0.01 m
+        SATELLITES,
+        HDOP,       // 0.01
+        FIELD_COUNT
+    };
+    bool valid[FIELD_COUNT];
+    int64_t value[FIELD_COUNT];
+    uint32_t passedChecksum;
+    uint32_t failedChecksum;
+    uint32_t sentencesWithFix;
+};
+
+class UpstreamParser
+{
+public:
+    UpstreamParser();
+    ~UpstreamParser();
+    bool encode(char c);
+    ParserState state() const;
+    static size_t parserSize();   // sizeof(TinyGPSPlus)
+    static const char* version();
+private:
+    struct Impl;
+    Impl* impl;
+};